@@ -0,0 +1,274 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+#include <zephyr.h>
+#include "activity_classifier.h"
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(activity_classifier, CONFIG_ACTIVITY_CLASSIFIER_LOG_LEVEL);
+
+/* Accelerometer output data rate in units of 0.01 Hz. */
+#if defined(CONFIG_ADXL362_ACCEL_ODR_12_5)
+#define ODR_CHZ 1250
+#elif defined(CONFIG_ADXL362_ACCEL_ODR_25)
+#define ODR_CHZ 2500
+#elif defined(CONFIG_ADXL362_ACCEL_ODR_50)
+#define ODR_CHZ 5000
+#elif defined(CONFIG_ADXL362_ACCEL_ODR_100)
+#define ODR_CHZ 10000
+#elif defined(CONFIG_ADXL362_ACCEL_ODR_200)
+#define ODR_CHZ 20000
+#elif defined(CONFIG_ADXL362_ACCEL_ODR_400)
+#define ODR_CHZ 40000
+#else
+#error "The accelerometer output data rate must be set at build time"
+#endif
+
+#define WINDOW_SAMPLES		CONFIG_ACTIVITY_CLASSIFIER_WINDOW_SAMPLES
+#define SAMPLE_PERIOD_US	(100000000LL / ODR_CHZ)
+#define WINDOW_DURATION_MS	(WINDOW_SAMPLES * SAMPLE_PERIOD_US / 1000)
+
+#define MG_PER_M_S2		(1000.0 / 9.80665)
+
+/* Magnitude changes smaller than this around the mean are not counted as
+ * zero crossings.
+ */
+#define ZERO_CROSSING_HYSTERESIS_MG	30
+
+/* Classification thresholds. A cat at rest shows little more than sensor
+ * noise. Jumps show a free fall followed by a landing impact, while running
+ * differs from walking in stride frequency and intensity.
+ */
+#define REST_VARIANCE_MAX	(40 * 40)
+#define JUMP_FREE_FALL_MAX_MG	300
+#define JUMP_IMPACT_MIN_MG	2500
+#define RUN_VARIANCE_MIN	(450 * 450)
+#define RUN_FREQUENCY_MIN	250
+
+/* Acceleration magnitude in mg of the window being filled. */
+static uint16_t window[WINDOW_SAMPLES];
+static size_t window_count;
+
+/* Uptime of the last sample added to the window. */
+static int64_t window_time;
+
+/* Time in milliseconds spent in each class since the last summary, and the
+ * uptime of the last summary. Accessed from the accelerometer trigger thread
+ * and the thread requesting summaries.
+ */
+static uint32_t class_time[ACTIVITY_COUNT];
+static int64_t summary_time;
+static struct k_spinlock lock;
+
+static const char *class2str(enum activity_class class)
+{
+	switch (class) {
+	case ACTIVITY_REST:
+		return "rest";
+	case ACTIVITY_WALK:
+		return "walk";
+	case ACTIVITY_RUN:
+		return "run";
+	case ACTIVITY_JUMP:
+		return "jump";
+	default:
+		return "unknown";
+	}
+}
+
+static uint16_t isqrt(uint32_t value)
+{
+	uint32_t result = 0;
+	uint32_t bit = BIT(30);
+
+	while (bit > value) {
+		bit >>= 2;
+	}
+
+	while (bit != 0) {
+		if (value >= result + bit) {
+			value -= result + bit;
+			result = (result >> 1) + bit;
+		} else {
+			result >>= 1;
+		}
+
+		bit >>= 2;
+	}
+
+	return result;
+}
+
+static void features_compute(const uint16_t *mag, size_t count,
+			     struct activity_features *features)
+{
+	int32_t dev[WINDOW_SAMPLES];
+	uint32_t sum = 0;
+	uint64_t sum_squares = 0;
+	int64_t acf_best = 0;
+	size_t lag_best = 0;
+	bool acf_negative = false;
+	int sign = 0;
+
+	features->min = UINT16_MAX;
+	features->max = 0;
+	features->zero_crossings = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		sum += mag[i];
+		features->min = MIN(features->min, mag[i]);
+		features->max = MAX(features->max, mag[i]);
+	}
+
+	features->mean = sum / count;
+
+	for (size_t i = 0; i < count; i++) {
+		dev[i] = (int32_t)mag[i] - features->mean;
+		sum_squares += (int64_t)dev[i] * dev[i];
+
+		if ((dev[i] > ZERO_CROSSING_HYSTERESIS_MG) && (sign <= 0)) {
+			features->zero_crossings += (sign < 0);
+			sign = 1;
+		} else if ((dev[i] < -ZERO_CROSSING_HYSTERESIS_MG) &&
+			   (sign >= 0)) {
+			features->zero_crossings += (sign > 0);
+			sign = -1;
+		}
+	}
+
+	features->variance = MIN(sum_squares / count, UINT32_MAX);
+
+	/* The dominant period is the lag of the first autocorrelation peak
+	 * after the autocorrelation has turned negative.
+	 */
+	for (size_t lag = 2; lag <= count / 2; lag++) {
+		int64_t acf = 0;
+
+		for (size_t i = 0; i + lag < count; i++) {
+			acf += dev[i] * dev[i + lag];
+		}
+
+		if ((lag_best > 0) && (acf < acf_best)) {
+			break;
+		} else if (acf < 0) {
+			acf_negative = true;
+		} else if (acf_negative) {
+			acf_best = acf;
+			lag_best = lag;
+		}
+	}
+
+	features->frequency = lag_best ? ODR_CHZ / lag_best : 0;
+}
+
+static enum activity_class classify(const struct activity_features *features)
+{
+	if (features->variance < REST_VARIANCE_MAX) {
+		return ACTIVITY_REST;
+	}
+
+	if ((features->min < JUMP_FREE_FALL_MAX_MG) &&
+	    (features->max > JUMP_IMPACT_MIN_MG)) {
+		return ACTIVITY_JUMP;
+	}
+
+	if ((features->variance > RUN_VARIANCE_MIN) ||
+	    (features->frequency > RUN_FREQUENCY_MIN)) {
+		return ACTIVITY_RUN;
+	}
+
+	return ACTIVITY_WALK;
+}
+
+static void window_classify(void)
+{
+	uint32_t start = k_cycle_get_32();
+	struct activity_features features;
+	enum activity_class class;
+	k_spinlock_key_t key;
+
+	features_compute(window, window_count, &features);
+	class = classify(&features);
+
+	LOG_DBG("Window classified as %s in %u cycles", class2str(class),
+		k_cycle_get_32() - start);
+	LOG_DBG("Mean: %d mg, variance: %u mg2, zero crossings: %d",
+		features.mean, features.variance, features.zero_crossings);
+	LOG_DBG("Min: %d mg, max: %d mg, frequency: %d.%02d Hz",
+		features.min, features.max, features.frequency / 100,
+		features.frequency % 100);
+
+	key = k_spin_lock(&lock);
+	class_time[class] += WINDOW_DURATION_MS;
+	k_spin_unlock(&lock, key);
+}
+
+void activity_classifier_samples_add(const double (*samples)[3], size_t count,
+				     int64_t time)
+{
+	int64_t first;
+
+	if (count == 0) {
+		return;
+	}
+
+	first = time - (count - 1) * SAMPLE_PERIOD_US / USEC_PER_MSEC;
+
+	/* Samples are only consecutive if the accelerometer FIFO has not
+	 * overflowed since the last block.
+	 */
+	if ((window_count > 0) &&
+	    (first - window_time > 2 * SAMPLE_PERIOD_US / USEC_PER_MSEC)) {
+		LOG_DBG("Gap in samples, %zu samples discarded", window_count);
+		window_count = 0;
+	}
+
+	window_time = time;
+
+	for (size_t i = 0; i < count; i++) {
+		int32_t x = samples[i][0] * MG_PER_M_S2;
+		int32_t y = samples[i][1] * MG_PER_M_S2;
+		int32_t z = samples[i][2] * MG_PER_M_S2;
+
+		window[window_count++] = isqrt(x * x + y * y + z * z);
+
+		if (window_count == WINDOW_SAMPLES) {
+			window_classify();
+			window_count = 0;
+		}
+	}
+}
+
+int activity_classifier_summary_get(struct activity_summary *summary,
+				    int64_t time)
+{
+	int err = 0;
+	uint32_t classified = 0;
+	uint32_t unclassified;
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	for (size_t i = 0; i < ACTIVITY_COUNT; i++) {
+		classified += class_time[i];
+		summary->time[i] = MIN(class_time[i] / MSEC_PER_SEC,
+				       UINT16_MAX);
+	}
+
+	if (classified == 0) {
+		err = -ENODATA;
+	} else if (time - summary_time > classified) {
+		unclassified = time - summary_time - classified;
+		summary->time[ACTIVITY_REST] =
+			MIN((class_time[ACTIVITY_REST] + unclassified) /
+			    MSEC_PER_SEC, UINT16_MAX);
+	}
+
+	memset(class_time, 0, sizeof(class_time));
+	summary_time = time;
+
+	k_spin_unlock(&lock, key);
+
+	return err;
+}
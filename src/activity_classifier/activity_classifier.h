@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+/**@file
+ *@brief Activity classifier library header.
+ */
+
+#ifndef ACTIVITY_CLASSIFIER_H__
+#define ACTIVITY_CLASSIFIER_H__
+
+#include <zephyr.h>
+
+/**@file
+ *
+ * @defgroup activity_classifier Activity classifier
+ * @brief    Module that classifies accelerometer data into activities.
+ * @{
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Activity classes. */
+enum activity_class {
+	ACTIVITY_REST,
+	ACTIVITY_WALK,
+	ACTIVITY_RUN,
+	ACTIVITY_JUMP,
+
+	ACTIVITY_COUNT
+};
+
+/** @brief Features of one window of samples. */
+struct activity_features {
+	/** Mean acceleration magnitude in mg. */
+	uint16_t mean;
+	/** Variance of the acceleration magnitude in mg^2. */
+	uint32_t variance;
+	/** Smallest and largest acceleration magnitude in mg. */
+	uint16_t min;
+	uint16_t max;
+	/** Number of times the magnitude crosses its mean. */
+	uint16_t zero_crossings;
+	/** Dominant frequency of the magnitude in units of 0.01 Hz, 0 if none
+	 *  was found.
+	 */
+	uint16_t frequency;
+};
+
+/** @brief Time spent in each activity class. */
+struct activity_summary {
+	/** Seconds per class, indexed by enum activity_class. */
+	uint16_t time[ACTIVITY_COUNT];
+};
+
+/**
+ * @brief Add a block of consecutive accelerometer samples. Every complete
+ *	  window of samples is classified.
+ *
+ * @param[in] samples X, Y and Z samples in m/s2, oldest first.
+ * @param[in] count Number of samples.
+ * @param[in] time Uptime of the last sample.
+ */
+void activity_classifier_samples_add(const double (*samples)[3], size_t count,
+				     int64_t time);
+
+/**
+ * @brief Get the time spent in each class since the last call. Time that is
+ *	  not covered by classified windows is counted as rest.
+ *
+ * @param[out] summary Activity summary.
+ * @param[in] time Current uptime.
+ *
+ * @return 0 on success, -ENODATA if no movement has been classified since the
+ *	   last call.
+ */
+int activity_classifier_summary_get(struct activity_summary *summary,
+				    int64_t time);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @}
+ */
+
+#endif /* ACTIVITY_CLASSIFIER_H__ */
@@ -0,0 +1,527 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+#include <zephyr.h>
+#include <drivers/gps.h>
+#include <settings/settings.h>
+#include <date_time.h>
+#include "agps_cache.h"
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(agps_cache, CONFIG_AGPS_CACHE_LOG_LEVEL);
+
+#define AGPS_CACHE_SETTINGS_KEY	"agps_cache"
+
+#define MSEC_PER_MIN		(60LL * MSEC_PER_SEC)
+#define MSEC_PER_HOUR		(60LL * MSEC_PER_MIN)
+#define MSEC_PER_DAY		(24LL * MSEC_PER_HOUR)
+
+/* Bits used in the mask of the UTC and ionospheric correction slot. */
+#define IONO_UTC_MASK_UTC	BIT(0)
+#define IONO_UTC_MASK_KLOBUCHAR	BIT(1)
+#define IONO_UTC_MASK_NEQUICK	BIT(2)
+
+/* nRF Cloud A-GPS binary format. The data starts with the schema version,
+ * followed by elements that each start with a type and a count.
+ */
+#define AGPS_BIN_SCHEMA_VERSION		1
+#define AGPS_BIN_TYPE_OFFSET		1
+
+#define AGPS_TYPE_UTC_PARAMETERS	1
+#define AGPS_TYPE_EPHEMERIDES		2
+#define AGPS_TYPE_ALMANAC		3
+#define AGPS_TYPE_KLOBUCHAR		4
+#define AGPS_TYPE_NEQUICK		5
+
+/* Time after which a request that has not been answered is sent again. */
+#define REQUEST_TIMEOUT_MS		(2 * MSEC_PER_MIN)
+
+/* Cached assistance data. Each slot holds the response to one cloud request
+ * and is stored to flash as one settings entry.
+ */
+enum slot_type {
+	SLOT_EPHEMERIDES,
+	SLOT_ALMANAC,
+	SLOT_IONO_UTC,
+	SLOT_COUNT
+};
+
+/* Header stored in front of the assistance data. */
+struct slot_header {
+	/* UNIX time in milliseconds when the data was received. */
+	int64_t timestamp;
+	/* Satellites, or element types, covered by the data. */
+	uint32_t mask;
+	/* Length of the assistance data. */
+	uint32_t len;
+};
+
+struct slot {
+	const char *key;
+	struct slot_header *header;
+	size_t size;
+	int64_t validity_ms;
+};
+
+static struct {
+	struct slot_header header;
+	uint8_t data[CONFIG_AGPS_CACHE_EPHEMERIDES_SIZE];
+} ephe_entry;
+
+static struct {
+	struct slot_header header;
+	uint8_t data[CONFIG_AGPS_CACHE_ALMANAC_SIZE];
+} alm_entry;
+
+static struct {
+	struct slot_header header;
+	uint8_t data[CONFIG_AGPS_CACHE_IONO_UTC_SIZE];
+} iono_utc_entry;
+
+static struct slot slots[SLOT_COUNT] = {
+	[SLOT_EPHEMERIDES] = {
+		.key = "ephe",
+		.header = &ephe_entry.header,
+		.size = sizeof(ephe_entry),
+		.validity_ms = CONFIG_AGPS_CACHE_EPHEMERIDES_VALIDITY_MIN *
+			       MSEC_PER_MIN
+	},
+	[SLOT_ALMANAC] = {
+		.key = "alm",
+		.header = &alm_entry.header,
+		.size = sizeof(alm_entry),
+		.validity_ms = CONFIG_AGPS_CACHE_ALMANAC_VALIDITY_HOURS *
+			       MSEC_PER_HOUR
+	},
+	[SLOT_IONO_UTC] = {
+		.key = "iono_utc",
+		.header = &iono_utc_entry.header,
+		.size = sizeof(iono_utc_entry),
+		.validity_ms = CONFIG_AGPS_CACHE_IONO_UTC_VALIDITY_HOURS *
+			       MSEC_PER_HOUR
+	},
+};
+
+/* Request to be sent to cloud. Each cached slot is requested separately so
+ * that every response holds the element types of one slot only. The
+ * requests are sent back to back, a response is matched with its slot by
+ * the element type it holds.
+ */
+struct cloud_request {
+	struct gps_agps_request request;
+	/* Slot that the response is stored in, SLOT_COUNT if not cached. */
+	enum slot_type slot;
+	uint32_t mask;
+};
+
+static struct cloud_request request_list[SLOT_COUNT + 1];
+static size_t request_count;
+
+/* Requests sent to cloud that have not been answered, per slot. */
+static struct {
+	/* Satellites, or element types, covered by the response. 0 if no
+	 * request is pending.
+	 */
+	uint32_t mask;
+	/* Uptime when the request was sent. */
+	int64_t time;
+} pending[SLOT_COUNT];
+
+/* A-GPS statistics, logged when data is received from cloud. */
+static struct {
+	/* Day since boot that bytes_downloaded refers to. */
+	int64_t day;
+	uint32_t bytes_downloaded;
+	uint32_t served;
+	uint32_t requested;
+} stats;
+
+static struct k_work request_work;
+
+K_MUTEX_DEFINE(cache_lock);
+
+static int settings_set(const char *key, size_t len,
+			settings_read_cb read_cb, void *cb_arg)
+{
+	int err;
+
+	for (size_t i = 0; i < ARRAY_SIZE(slots); i++) {
+		if (strcmp(key, slots[i].key) != 0) {
+			continue;
+		}
+
+		if (len > slots[i].size) {
+			LOG_WRN("Cached %s too large: %d",
+				log_strdup(key), len);
+			return -EINVAL;
+		}
+
+		err = read_cb(cb_arg, slots[i].header, len);
+		if (err < 0) {
+			LOG_ERR("Failed to load %s, error: %d",
+				log_strdup(key), err);
+			return err;
+		}
+
+		if (slots[i].header->len + sizeof(struct slot_header) != len) {
+			LOG_WRN("Cached %s is corrupt", log_strdup(key));
+			slots[i].header->len = 0;
+		}
+
+		return 0;
+	}
+
+	return 0;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(agps_cache, AGPS_CACHE_SETTINGS_KEY, NULL,
+			       settings_set, NULL, NULL);
+
+static uint8_t *slot_data(struct slot *slot)
+{
+	return (uint8_t *)(slot->header + 1);
+}
+
+static bool slot_valid(enum slot_type type, uint32_t mask)
+{
+	int err;
+	int64_t now;
+	struct slot_header *header = slots[type].header;
+
+	if (header->len == 0) {
+		return false;
+	}
+
+	err = date_time_now(&now);
+	if (err) {
+		return false;
+	}
+
+	if ((now - header->timestamp) > slots[type].validity_ms) {
+		LOG_DBG("Cached %s expired", log_strdup(slots[type].key));
+		return false;
+	}
+
+	return (header->mask & mask) == mask;
+}
+
+static void slot_store(enum slot_type type, uint32_t mask,
+		       const char *buf, size_t len)
+{
+	int err;
+	int64_t now;
+	char key[sizeof(AGPS_CACHE_SETTINGS_KEY) + 10];
+	struct slot *slot = &slots[type];
+
+	if (len + sizeof(struct slot_header) > slot->size) {
+		LOG_WRN("A-GPS data too large to be cached: %d", len);
+		return;
+	}
+
+	/* Cached data cannot be validated later without a timestamp. */
+	err = date_time_now(&now);
+	if (err) {
+		LOG_WRN("No valid time, A-GPS data not cached");
+		return;
+	}
+
+	slot->header->timestamp = now;
+	slot->header->mask = mask;
+	slot->header->len = len;
+	memcpy(slot_data(slot), buf, len);
+
+	snprintf(key, sizeof(key), AGPS_CACHE_SETTINGS_KEY "/%s", slot->key);
+
+	err = settings_save_one(key, slot->header,
+				len + sizeof(struct slot_header));
+	if (err) {
+		LOG_WRN("settings_save_one, error: %d", err);
+		return;
+	}
+
+	LOG_DBG("Cached %s, %d bytes", log_strdup(slot->key), len);
+}
+
+/* Write cached assistance data to the GPS. Returns true if the data was
+ * accepted.
+ */
+static bool slot_write(enum slot_type type)
+{
+	int err;
+	struct slot *slot = &slots[type];
+
+	err = gps_process_agps_data(slot_data(slot), slot->header->len);
+	if (err) {
+		LOG_WRN("Cached %s not accepted, error: %d",
+			log_strdup(slot->key), err);
+		slot->header->len = 0;
+		return false;
+	}
+
+	LOG_DBG("Cached %s written to GPS", log_strdup(slot->key));
+
+	stats.served++;
+
+	return true;
+}
+
+/* Slot that A-GPS data from cloud is stored in, given by the type of its
+ * first element. SLOT_COUNT if the data is not cached.
+ */
+static enum slot_type slot_get(const char *buf, size_t len)
+{
+	if ((len <= AGPS_BIN_TYPE_OFFSET) ||
+	    (buf[0] != AGPS_BIN_SCHEMA_VERSION)) {
+		return SLOT_COUNT;
+	}
+
+	switch (buf[AGPS_BIN_TYPE_OFFSET]) {
+	case AGPS_TYPE_EPHEMERIDES:
+		return SLOT_EPHEMERIDES;
+	case AGPS_TYPE_ALMANAC:
+		return SLOT_ALMANAC;
+	case AGPS_TYPE_UTC_PARAMETERS:
+	case AGPS_TYPE_KLOBUCHAR:
+	case AGPS_TYPE_NEQUICK:
+		return SLOT_IONO_UTC;
+	default:
+		return SLOT_COUNT;
+	}
+}
+
+/* Returns true if a request for the slot covering the mask has been sent
+ * and can still be answered.
+ */
+static bool slot_pending(enum slot_type type, uint32_t mask)
+{
+	if ((k_uptime_get() - pending[type].time) > REQUEST_TIMEOUT_MS) {
+		pending[type].mask = 0;
+	}
+
+	return (pending[type].mask & mask) == mask;
+}
+
+static void request_add(struct gps_agps_request *request,
+			enum slot_type slot, uint32_t mask)
+{
+	request_list[request_count].request = *request;
+	request_list[request_count].slot = slot;
+	request_list[request_count].mask = mask;
+	request_count++;
+
+	stats.requested++;
+}
+
+static void request_sent(const struct cloud_request *request)
+{
+	enum slot_type slot = request->slot;
+
+	if (slot == SLOT_COUNT) {
+		return;
+	}
+
+	/* A response cannot be told apart from the response to an earlier
+	 * request for the same slot. It is cached as covering what both
+	 * requests have in common.
+	 */
+	pending[slot].mask = pending[slot].mask ?
+			     (pending[slot].mask & request->mask) :
+			     request->mask;
+	pending[slot].time = k_uptime_get();
+}
+
+static void request_work_fn(struct k_work *work)
+{
+	int err;
+	struct cloud_request request;
+
+	for (;;) {
+		k_mutex_lock(&cache_lock, K_FOREVER);
+
+		if (request_count == 0) {
+			k_mutex_unlock(&cache_lock);
+			return;
+		}
+
+		request = request_list[0];
+		request_count--;
+		memmove(&request_list[0], &request_list[1],
+			request_count * sizeof(request_list[0]));
+
+		/* Marked as pending before it is sent, the response can
+		 * arrive before gps_agps_request() returns.
+		 */
+		request_sent(&request);
+
+		k_mutex_unlock(&cache_lock);
+
+		err = gps_agps_request(request.request,
+				       GPS_SOCKET_NOT_PROVIDED);
+		if (err) {
+			LOG_WRN("Failed to request A-GPS data, error: %d", err);
+			agps_cache_requests_abort();
+			return;
+		}
+	}
+}
+
+static void stats_update(size_t len)
+{
+	int64_t day = k_uptime_get() / MSEC_PER_DAY;
+
+	if (day != stats.day) {
+		LOG_INF("A-GPS data downloaded during day %lld: %d bytes",
+			stats.day, stats.bytes_downloaded);
+		stats.day = day;
+		stats.bytes_downloaded = 0;
+	}
+
+	stats.bytes_downloaded += len;
+
+	LOG_DBG("A-GPS downloaded today: %d bytes", stats.bytes_downloaded);
+	LOG_DBG("A-GPS served from cache: %d, requested from cloud: %d",
+		stats.served, stats.requested);
+}
+
+int agps_cache_init(void)
+{
+	int err;
+
+	k_work_init(&request_work, request_work_fn);
+
+	err = settings_subsys_init();
+	if (err) {
+		LOG_ERR("settings_subsys_init, error: %d", err);
+		return err;
+	}
+
+	err = settings_load_subtree(AGPS_CACHE_SETTINGS_KEY);
+	if (err) {
+		LOG_ERR("settings_load_subtree, error: %d", err);
+		return err;
+	}
+
+	return 0;
+}
+
+int agps_cache_request(struct gps_agps_request request)
+{
+	uint32_t iono_utc_mask = 0;
+	struct gps_agps_request cloud_request = {0};
+
+	k_mutex_lock(&cache_lock, K_FOREVER);
+
+	/* Requests that have not been sent yet are replaced. Requests that
+	 * have been sent are not repeated, their responses are still written
+	 * to the GPS and cached when they arrive.
+	 */
+	request_count = 0;
+
+	/* Time, position and integrity assistance is only valid for a short
+	 * time and is always requested from cloud. It is requested first, as
+	 * it has the largest impact on time to fix.
+	 */
+	if (request.system_time_tow || request.position || request.integrity) {
+		cloud_request.system_time_tow = request.system_time_tow;
+		cloud_request.position = request.position;
+		cloud_request.integrity = request.integrity;
+
+		request_add(&cloud_request, SLOT_COUNT, 0);
+	}
+
+	if (request.sv_mask_ephe) {
+		if ((!slot_valid(SLOT_EPHEMERIDES, request.sv_mask_ephe) ||
+		     !slot_write(SLOT_EPHEMERIDES)) &&
+		    !slot_pending(SLOT_EPHEMERIDES, request.sv_mask_ephe)) {
+			cloud_request = (struct gps_agps_request) {
+				.sv_mask_ephe = request.sv_mask_ephe
+			};
+
+			request_add(&cloud_request, SLOT_EPHEMERIDES,
+				    request.sv_mask_ephe);
+		}
+	}
+
+	if (request.sv_mask_alm) {
+		if ((!slot_valid(SLOT_ALMANAC, request.sv_mask_alm) ||
+		     !slot_write(SLOT_ALMANAC)) &&
+		    !slot_pending(SLOT_ALMANAC, request.sv_mask_alm)) {
+			cloud_request = (struct gps_agps_request) {
+				.sv_mask_alm = request.sv_mask_alm
+			};
+
+			request_add(&cloud_request, SLOT_ALMANAC,
+				    request.sv_mask_alm);
+		}
+	}
+
+	iono_utc_mask |= request.utc ? IONO_UTC_MASK_UTC : 0;
+	iono_utc_mask |= request.klobuchar ? IONO_UTC_MASK_KLOBUCHAR : 0;
+	iono_utc_mask |= request.nequick ? IONO_UTC_MASK_NEQUICK : 0;
+
+	if (iono_utc_mask) {
+		if ((!slot_valid(SLOT_IONO_UTC, iono_utc_mask) ||
+		     !slot_write(SLOT_IONO_UTC)) &&
+		    !slot_pending(SLOT_IONO_UTC, iono_utc_mask)) {
+			cloud_request = (struct gps_agps_request) {
+				.utc = request.utc,
+				.klobuchar = request.klobuchar,
+				.nequick = request.nequick
+			};
+
+			request_add(&cloud_request, SLOT_IONO_UTC,
+				    iono_utc_mask);
+		}
+	}
+
+	LOG_DBG("%d A-GPS requests to be sent to cloud", request_count);
+
+	k_mutex_unlock(&cache_lock);
+
+	k_work_submit(&request_work);
+
+	return 0;
+}
+
+int agps_cache_data_process(const char *buf, size_t len)
+{
+	int err;
+	enum slot_type slot;
+
+	err = gps_process_agps_data(buf, len);
+	if (err) {
+		return err;
+	}
+
+	k_mutex_lock(&cache_lock, K_FOREVER);
+
+	stats_update(len);
+
+	slot = slot_get(buf, len);
+
+	/* Data that was not requested by this library, or whose request was
+	 * aborted, is only written to the GPS, the satellites it covers are
+	 * not known.
+	 */
+	if ((slot != SLOT_COUNT) && pending[slot].mask) {
+		slot_store(slot, pending[slot].mask, buf, len);
+		pending[slot].mask = 0;
+	}
+
+	k_mutex_unlock(&cache_lock);
+
+	return 0;
+}
+
+void agps_cache_requests_abort(void)
+{
+	k_mutex_lock(&cache_lock, K_FOREVER);
+
+	request_count = 0;
+	memset(pending, 0, sizeof(pending));
+
+	k_mutex_unlock(&cache_lock);
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+/**@file
+ *@brief A-GPS cache library header.
+ */
+
+#ifndef AGPS_CACHE_H__
+#define AGPS_CACHE_H__
+
+#include <zephyr.h>
+#include <drivers/gps.h>
+
+/**@file
+ *
+ * @defgroup agps_cache A-GPS cache
+ * @brief    Module that caches A-GPS assistance data in flash.
+ * @{
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Initialize the library and load cached assistance data from flash.
+ *
+ * @return 0 on success or negative error value on failure.
+ */
+int agps_cache_init(void);
+
+/**
+ * @brief Handle an A-GPS request from the GPS. Cached elements that are still
+ *	  valid are written to the GPS. Missing or expired elements are
+ *	  requested from cloud with one request per cached element type,
+ *	  sent back to back. Elements that have already been requested and
+ *	  not yet received are not requested again.
+ *
+ * @param[in] request A-GPS elements requested by the GPS.
+ *
+ * @return 0 on success or negative error value on failure.
+ */
+int agps_cache_request(struct gps_agps_request request);
+
+/**
+ * @brief Process A-GPS data received from cloud. The data is written to the
+ *	  GPS and stored in the cache, in the slot given by its element type,
+ *	  if that element type has been requested by the library.
+ *
+ * @param[in] buf Pointer to A-GPS data.
+ * @param[in] len Length of A-GPS data.
+ *
+ * @return 0 on success or negative error value on failure.
+ */
+int agps_cache_data_process(const char *buf, size_t len);
+
+/**
+ * @brief Abort outstanding cloud requests. Should be called when the
+ *	  connection to cloud is lost.
+ */
+void agps_cache_requests_abort(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @}
+ */
+
+#endif /* AGPS_CACHE_H__ */
@@ -120,6 +120,12 @@ void aws_iot_event_handler(const struct aws_iot_evt *const evt)
 		cloud_wrap_evt.data.len = evt->data.msg.len;
 		notify = true;
 		break;
+	case AWS_IOT_EVT_PUBACK:
+		LOG_DBG("AWS_IOT_EVT_PUBACK");
+		cloud_wrap_evt.type = CLOUD_WRAP_EVT_DATA_ACK;
+		cloud_wrap_evt.message_id = evt->data.message_id;
+		notify = true;
+		break;
 	case AWS_IOT_EVT_FOTA_START:
 		LOG_DBG("AWS_IOT_EVT_FOTA_START");
 		cloud_wrap_evt.type = CLOUD_WRAP_EVT_FOTA_START;
@@ -259,14 +265,15 @@ int cloud_wrap_state_get(void)
 	return 0;
 }
 
-int cloud_wrap_state_send(char *buf, size_t len)
+int cloud_wrap_state_send(char *buf, size_t len, uint16_t message_id)
 {
 	int err;
 
 	struct aws_iot_data msg = {
 		.ptr = buf,
 		.len = len,
-		.qos = MQTT_QOS_0_AT_MOST_ONCE,
+		.qos = CLOUD_WRAP_DATA_QOS,
+		.message_id = message_id,
 		.topic.type = AWS_IOT_SHADOW_TOPIC_UPDATE,
 	};
 
@@ -279,15 +286,21 @@ int cloud_wrap_state_send(char *buf, size_t len)
 	return 0;
 }
 
-int cloud_wrap_data_send(char *buf, size_t len)
+int cloud_wrap_data_send(char *buf, size_t len, uint16_t message_id)
 {
 	int err;
 
 	struct aws_iot_data msg = {
 		.ptr = buf,
 		.len = len,
-		.qos = MQTT_QOS_0_AT_MOST_ONCE,
+		.qos = CLOUD_WRAP_DATA_QOS,
+		.message_id = message_id,
+#if defined(CONFIG_AWS_IOT_INTEGRATION_TELEMETRY_TOPIC)
+		/* <imei>/messages */
+		.topic = pub_topics[1]
+#else
 		.topic.type = AWS_IOT_SHADOW_TOPIC_UPDATE,
+#endif
 	};
 
 	err = aws_iot_send(&msg);
@@ -299,14 +312,15 @@ int cloud_wrap_data_send(char *buf, size_t len)
 	return 0;
 }
 
-int cloud_wrap_batch_send(char *buf, size_t len)
+int cloud_wrap_batch_send(char *buf, size_t len, uint16_t message_id)
 {
 	int err;
 
 	struct aws_iot_data msg = {
 		.ptr = buf,
 		.len = len,
-		.qos = MQTT_QOS_0_AT_MOST_ONCE,
+		.qos = CLOUD_WRAP_DATA_QOS,
+		.message_id = message_id,
 		/* <imei>/batch */
 		.topic = pub_topics[0]
 	};
@@ -320,14 +334,15 @@ int cloud_wrap_batch_send(char *buf, size_t len)
 	return 0;
 }
 
-int cloud_wrap_ui_send(char *buf, size_t len)
+int cloud_wrap_ui_send(char *buf, size_t len, uint16_t message_id)
 {
 	int err;
 
 	struct aws_iot_data msg = {
 		.ptr = buf,
 		.len = len,
-		.qos = MQTT_QOS_0_AT_MOST_ONCE,
+		.qos = CLOUD_WRAP_DATA_QOS,
+		.message_id = message_id,
 		/* <imei>/messages */
 		.topic = pub_topics[1]
 	};
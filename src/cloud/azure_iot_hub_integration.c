@@ -105,6 +105,9 @@ static void azure_iot_hub_event_handler(struct azure_iot_hub_evt *const evt)
 		break;
 	case AZURE_IOT_HUB_EVT_PUBACK:
 		LOG_DBG("AZURE_IOT_HUB_EVT_PUBACK");
+		cloud_wrap_evt.type = CLOUD_WRAP_EVT_DATA_ACK;
+		cloud_wrap_evt.message_id = evt->data.message_id;
+		notify = true;
 		break;
 	case AZURE_IOT_HUB_EVT_ERROR:
 		LOG_DBG("AZURE_IOT_HUB_EVT_ERROR");
@@ -235,14 +238,15 @@ int cloud_wrap_state_get(void)
 	return 0;
 }
 
-int cloud_wrap_state_send(char *buf, size_t len)
+int cloud_wrap_state_send(char *buf, size_t len, uint16_t message_id)
 {
 	int err;
 
 	struct azure_iot_hub_data msg = {
 		.ptr = buf,
 		.len = len,
-		.qos = MQTT_QOS_0_AT_MOST_ONCE,
+		.qos = CLOUD_WRAP_DATA_QOS,
+		.message_id = message_id,
 		.topic.type = AZURE_IOT_HUB_TOPIC_TWIN_REPORTED,
 	};
 
@@ -255,14 +259,15 @@ int cloud_wrap_state_send(char *buf, size_t len)
 	return 0;
 }
 
-int cloud_wrap_data_send(char *buf, size_t len)
+int cloud_wrap_data_send(char *buf, size_t len, uint16_t message_id)
 {
 	int err;
 
 	struct azure_iot_hub_data msg = {
 		.ptr = buf,
 		.len = len,
-		.qos = MQTT_QOS_0_AT_MOST_ONCE,
+		.qos = CLOUD_WRAP_DATA_QOS,
+		.message_id = message_id,
 		.topic.type = AZURE_IOT_HUB_TOPIC_TWIN_REPORTED,
 	};
 
@@ -275,14 +280,15 @@ int cloud_wrap_data_send(char *buf, size_t len)
 	return 0;
 }
 
-int cloud_wrap_batch_send(char *buf, size_t len)
+int cloud_wrap_batch_send(char *buf, size_t len, uint16_t message_id)
 {
 	int err;
 
 	struct azure_iot_hub_data msg = {
 		.ptr = buf,
 		.len = len,
-		.qos = MQTT_QOS_0_AT_MOST_ONCE,
+		.qos = CLOUD_WRAP_DATA_QOS,
+		.message_id = message_id,
 		.topic.type = AZURE_IOT_HUB_TOPIC_EVENT,
 		.topic.prop_bag = prop_bag_batch,
 		.topic.prop_bag_count = ARRAY_SIZE(prop_bag_batch)
@@ -297,14 +303,15 @@ int cloud_wrap_batch_send(char *buf, size_t len)
 	return 0;
 }
 
-int cloud_wrap_ui_send(char *buf, size_t len)
+int cloud_wrap_ui_send(char *buf, size_t len, uint16_t message_id)
 {
 	int err;
 
 	struct azure_iot_hub_data msg = {
 		.ptr = buf,
 		.len = len,
-		.qos = MQTT_QOS_0_AT_MOST_ONCE,
+		.qos = CLOUD_WRAP_DATA_QOS,
+		.message_id = message_id,
 		.topic.type = AZURE_IOT_HUB_TOPIC_EVENT
 	};
 
@@ -29,6 +29,9 @@ LOG_MODULE_REGISTER(cloud_codec, CONFIG_CLOUD_CODEC_LOG_LEVEL);
 #define MODEM_MCCMNC		"mccmnc"
 #define MODEM_CELL_ID		"cell"
 #define MODEM_IP_ADDRESS	"ip"
+#define MODEM_RADIO_COST	"rcost"
+#define MODEM_RADIO_DAY		"rday"
+#define MODEM_RADIO_OTHER	"roth"
 
 #define CONFIG_DEVICE_MODE	"act"
 #define CONFIG_ACTIVE_TIMEOUT	"actwt"
@@ -36,6 +39,16 @@ LOG_MODULE_REGISTER(cloud_codec, CONFIG_CLOUD_CODEC_LOG_LEVEL);
 #define CONFIG_MOVE_RES		"mvres"
 #define CONFIG_GPS_TIMEOUT	"gpst"
 #define CONFIG_ACC_THRESHOLD	"acct"
+#define CONFIG_TRACKING_MODE	"trk"
+#define CONFIG_TRACKING_INT	"trki"
+#define CONFIG_TRACKING_DUR	"trkd"
+#define CONFIG_TRACKING_START	"trks"
+#define CONFIG_TEMP_DELTA	"tempd"
+#define CONFIG_HUMID_DELTA	"humd"
+#define CONFIG_BAT_DELTA	"batd"
+#define CONFIG_RSRP_DELTA	"rsrpd"
+#define CONFIG_MAX_SILENCE	"maxsil"
+#define CONFIG_REPORTED_VERSION	"ver"
 
 #define OBJECT_CONFIG		"cfg"
 #define OBJECT_REPORTED		"reported"
@@ -56,6 +69,13 @@ LOG_MODULE_REGISTER(cloud_codec, CONFIG_CLOUD_CODEC_LOG_LEVEL);
 #define DATA_MOVEMENT_X		"x"
 #define DATA_MOVEMENT_Y		"y"
 #define DATA_MOVEMENT_Z		"z"
+#define DATA_MOVEMENT_PEAK_X	"px"
+#define DATA_MOVEMENT_PEAK_Y	"py"
+#define DATA_MOVEMENT_PEAK_Z	"pz"
+#define DATA_MOVEMENT_COUNT	"cnt"
+#define DATA_MOVEMENT_DURATION	"dur"
+
+#define DATA_ACTIVITY		"actv"
 
 #define DATA_GPS		"gps"
 #define DATA_GPS_LONGITUDE	"lng"
@@ -63,6 +83,13 @@ LOG_MODULE_REGISTER(cloud_codec, CONFIG_CLOUD_CODEC_LOG_LEVEL);
 #define DATA_GPS_ALTITUDE	"alt"
 #define DATA_GPS_SPEED		"spd"
 #define DATA_GPS_HEADING	"hdg"
+#define DATA_GPS_AGE		"age"
+#define DATA_GPS_ESTIMATED	"est"
+
+#define DATA_TRACK		"trk"
+#define DATA_TRACK_POINTS	"d"
+
+#define DATA_CELL_TRAIL	"ctr"
 
 /* Static functions */
 static int static_modem_data_add(cJSON *parent,
@@ -161,6 +188,15 @@ static int dynamic_modem_data_add(cJSON *parent,
 	err += json_add_number(dynamic_m_v, MODEM_CELL_ID, data->cell);
 	err += json_add_str(dynamic_m_v, MODEM_IP_ADDRESS, data->ip);
 
+	if (data->radio) {
+		err += json_add_number(dynamic_m_v, MODEM_RADIO_COST,
+				       data->radio_cost);
+		err += json_add_number(dynamic_m_v, MODEM_RADIO_DAY,
+				       data->radio_day);
+		err += json_add_number(dynamic_m_v, MODEM_RADIO_OTHER,
+				       data->radio_other);
+	}
+
 	err += json_add_obj(dynamic_m, OBJECT_VALUE, dynamic_m_v);
 	err += json_add_number(dynamic_m, OBJECT_TIMESTAMP, data->ts);
 
@@ -258,6 +294,14 @@ static int gps_data_add(cJSON *parent, struct cloud_data_gps *data,
 	err += json_add_number(gps_val_obj, DATA_GPS_SPEED, data->spd);
 	err += json_add_number(gps_val_obj, DATA_GPS_HEADING, data->hdg);
 
+	if (data->reused) {
+		err += json_add_number(gps_val_obj, DATA_GPS_AGE, data->age);
+	}
+
+	if (data->estimated) {
+		err += json_add_bool(gps_val_obj, DATA_GPS_ESTIMATED, true);
+	}
+
 	err += json_add_obj(gps_obj, OBJECT_VALUE, gps_val_obj);
 	err += json_add_number(gps_obj, OBJECT_TIMESTAMP, data->gps_ts);
 
@@ -305,6 +349,12 @@ static int accel_data_add(cJSON *parent, struct cloud_data_accelerometer *data,
 	err += json_add_number(acc_v_obj, DATA_MOVEMENT_X, data->values[0]);
 	err += json_add_number(acc_v_obj, DATA_MOVEMENT_Y, data->values[1]);
 	err += json_add_number(acc_v_obj, DATA_MOVEMENT_Z, data->values[2]);
+	err += json_add_number(acc_v_obj, DATA_MOVEMENT_PEAK_X, data->peak[0]);
+	err += json_add_number(acc_v_obj, DATA_MOVEMENT_PEAK_Y, data->peak[1]);
+	err += json_add_number(acc_v_obj, DATA_MOVEMENT_PEAK_Z, data->peak[2]);
+	err += json_add_number(acc_v_obj, DATA_MOVEMENT_COUNT, data->count);
+	err += json_add_number(acc_v_obj, DATA_MOVEMENT_DURATION,
+			       data->duration);
 
 	err += json_add_obj(acc_obj, OBJECT_VALUE, acc_v_obj);
 	err += json_add_number(acc_obj, OBJECT_TIMESTAMP, data->ts);
@@ -325,6 +375,218 @@ exit:
 	return 0;
 }
 
+static int activity_data_add(cJSON *parent, struct cloud_data_activity *data,
+			     bool batch_entry)
+{
+	int err = 0;
+
+	if (!data->queued) {
+		LOG_DBG("Head of activity buffer not indexing a queued entry");
+		goto exit;
+	}
+
+	err = date_time_uptime_to_unix_time_ms(&data->ts);
+	if (err) {
+		LOG_ERR("date_time_uptime_to_unix_time_ms, error: %d", err);
+		return err;
+	}
+
+	cJSON *activity_obj = cJSON_CreateObject();
+	cJSON *activity_val_obj = cJSON_CreateArray();
+
+	if (activity_obj == NULL || activity_val_obj == NULL) {
+		cJSON_Delete(activity_obj);
+		cJSON_Delete(activity_val_obj);
+		return -ENOMEM;
+	}
+
+	/* Seconds per activity are encoded as a [rest, walk, run, jump]
+	 * array.
+	 */
+	int values[] = { data->rest, data->walk, data->run, data->jump };
+
+	for (int i = 0; i < ARRAY_SIZE(values); i++) {
+		cJSON *value = cJSON_CreateNumber(values[i]);
+
+		if (value == NULL) {
+			cJSON_Delete(activity_obj);
+			cJSON_Delete(activity_val_obj);
+			return -ENOMEM;
+		}
+
+		err += json_add_obj_array(activity_val_obj, value);
+	}
+
+	err += json_add_obj(activity_obj, OBJECT_VALUE, activity_val_obj);
+	err += json_add_number(activity_obj, OBJECT_TIMESTAMP, data->ts);
+
+	if (batch_entry) {
+		err += json_add_obj_array(parent, activity_obj);
+	} else {
+		err += json_add_obj(parent, DATA_ACTIVITY, activity_obj);
+	}
+
+	if (err) {
+		return err;
+	}
+
+	data->queued = false;
+
+exit:
+	return 0;
+}
+
+static int track_data_add(cJSON *parent, struct cloud_data_track *data)
+{
+	int err = 0;
+
+	if (!data->queued) {
+		LOG_DBG("Track segment not queued");
+		goto exit;
+	}
+
+	err = date_time_uptime_to_unix_time_ms(&data->ts);
+	if (err) {
+		LOG_ERR("date_time_uptime_to_unix_time_ms, error: %d", err);
+		return err;
+	}
+
+	cJSON *trk_obj = cJSON_CreateObject();
+	cJSON *trk_val_obj = cJSON_CreateObject();
+	cJSON *points_obj = cJSON_CreateArray();
+
+	if (trk_obj == NULL || trk_val_obj == NULL || points_obj == NULL) {
+		cJSON_Delete(trk_obj);
+		cJSON_Delete(trk_val_obj);
+		cJSON_Delete(points_obj);
+		return -ENOMEM;
+	}
+
+	/* Points are encoded as a flat array of [dt, dlat, dlng] triplets to
+	 * keep the size of the segment down.
+	 */
+	for (int i = 0; i < data->count; i++) {
+		struct cloud_data_track_point *point = &data->points[i];
+		int values[] = { point->dt, point->dlat, point->dlng };
+
+		for (int j = 0; j < ARRAY_SIZE(values); j++) {
+			cJSON *value = cJSON_CreateNumber(values[j]);
+
+			if (value == NULL) {
+				cJSON_Delete(trk_obj);
+				cJSON_Delete(trk_val_obj);
+				cJSON_Delete(points_obj);
+				return -ENOMEM;
+			}
+
+			err += json_add_obj_array(points_obj, value);
+		}
+	}
+
+	err += json_add_number(trk_val_obj, DATA_GPS_LATITUDE,
+			       data->lat / 1000000.0);
+	err += json_add_number(trk_val_obj, DATA_GPS_LONGITUDE,
+			       data->lng / 1000000.0);
+	err += json_add_obj(trk_val_obj, DATA_TRACK_POINTS, points_obj);
+
+	err += json_add_obj(trk_obj, OBJECT_VALUE, trk_val_obj);
+	err += json_add_number(trk_obj, OBJECT_TIMESTAMP, data->ts);
+	err += json_add_obj_array(parent, trk_obj);
+
+	if (err) {
+		return err;
+	}
+
+	data->queued = false;
+
+exit:
+	return 0;
+}
+
+static int cell_trail_data_add(cJSON *parent,
+			       struct cloud_data_cell_trail *data,
+			       size_t count)
+{
+	int err = 0;
+	size_t first = count;
+	int64_t ts;
+	int64_t ts_prev;
+
+	/* The trail is encoded in chronological order, starting with the
+	 * oldest queued entry in the ringbuffer.
+	 */
+	for (size_t i = 0; i < count; i++) {
+		if (data[i].queued &&
+		    ((first == count) || (data[i].ts < data[first].ts))) {
+			first = i;
+		}
+	}
+
+	if (first == count) {
+		LOG_DBG("No queued cell trail entries");
+		return 0;
+	}
+
+	ts = data[first].ts;
+	ts_prev = ts;
+
+	err = date_time_uptime_to_unix_time_ms(&ts);
+	if (err) {
+		LOG_ERR("date_time_uptime_to_unix_time_ms, error: %d", err);
+		return err;
+	}
+
+	cJSON *values_obj = cJSON_CreateArray();
+
+	if (values_obj == NULL) {
+		return -ENOMEM;
+	}
+
+	/* Entries are encoded as a flat array of [dt, cell, area, rsrp]
+	 * quadruplets, where dt is the time in seconds since the previous
+	 * entry.
+	 */
+	for (size_t i = 0; i < count; i++) {
+		struct cloud_data_cell_trail *entry;
+		int64_t dt;
+
+		entry = &data[(first + i) % count];
+
+		if (!entry->queued) {
+			continue;
+		}
+
+		dt = (entry->ts - ts_prev) / MSEC_PER_SEC;
+		ts_prev += dt * MSEC_PER_SEC;
+
+		double values[] = { dt, entry->cell, entry->area, entry->rsrp };
+
+		for (int j = 0; j < ARRAY_SIZE(values); j++) {
+			cJSON *value = cJSON_CreateNumber(values[j]);
+
+			if (value == NULL) {
+				cJSON_Delete(values_obj);
+				return -ENOMEM;
+			}
+
+			err += json_add_obj_array(values_obj, value);
+		}
+	}
+
+	err += json_add_obj(parent, OBJECT_VALUE, values_obj);
+	err += json_add_number(parent, OBJECT_TIMESTAMP, ts);
+
+	if (err) {
+		return err;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		data[i].queued = false;
+	}
+
+	return 0;
+}
+
 static int ui_data_add(cJSON *parent, struct cloud_data_ui *data,
 		       bool batch_entry)
 {
@@ -422,6 +684,15 @@ int cloud_codec_decode_config(char *input, struct cloud_data_cfg *data)
 	cJSON *move_res = NULL;
 	cJSON *move_timeout = NULL;
 	cJSON *acc_thres = NULL;
+	cJSON *tracking = NULL;
+	cJSON *tracking_int = NULL;
+	cJSON *tracking_dur = NULL;
+	cJSON *tracking_start = NULL;
+	cJSON *temp_delta = NULL;
+	cJSON *hum_delta = NULL;
+	cJSON *bat_delta = NULL;
+	cJSON *rsrp_delta = NULL;
+	cJSON *max_silence = NULL;
 
 	if (input == NULL) {
 		return -EINVAL;
@@ -462,6 +733,16 @@ get_data:
 	move_res = cJSON_GetObjectItem(subgroup_obj, CONFIG_MOVE_RES);
 	move_timeout = cJSON_GetObjectItem(subgroup_obj, CONFIG_MOVE_TIMEOUT);
 	acc_thres = cJSON_GetObjectItem(subgroup_obj, CONFIG_ACC_THRESHOLD);
+	tracking = cJSON_GetObjectItem(subgroup_obj, CONFIG_TRACKING_MODE);
+	tracking_int = cJSON_GetObjectItem(subgroup_obj, CONFIG_TRACKING_INT);
+	tracking_dur = cJSON_GetObjectItem(subgroup_obj, CONFIG_TRACKING_DUR);
+	tracking_start = cJSON_GetObjectItem(subgroup_obj,
+					     CONFIG_TRACKING_START);
+	temp_delta = cJSON_GetObjectItem(subgroup_obj, CONFIG_TEMP_DELTA);
+	hum_delta = cJSON_GetObjectItem(subgroup_obj, CONFIG_HUMID_DELTA);
+	bat_delta = cJSON_GetObjectItem(subgroup_obj, CONFIG_BAT_DELTA);
+	rsrp_delta = cJSON_GetObjectItem(subgroup_obj, CONFIG_RSRP_DELTA);
+	max_silence = cJSON_GetObjectItem(subgroup_obj, CONFIG_MAX_SILENCE);
 
 	if (gps_timeout != NULL) {
 		data->gps_timeout = gps_timeout->valueint;
@@ -487,13 +768,51 @@ get_data:
 		data->accelerometer_threshold = acc_thres->valuedouble;
 	}
 
+	if (tracking != NULL) {
+		data->tracking_mode = tracking->valueint;
+	}
+
+	if (tracking_int != NULL) {
+		data->tracking_interval = tracking_int->valueint;
+	}
+
+	if (tracking_dur != NULL) {
+		data->tracking_duration = tracking_dur->valueint;
+	}
+
+	if (tracking_start != NULL) {
+		data->tracking_start = tracking_start->valueint;
+	}
+
+	if (temp_delta != NULL) {
+		data->temperature_delta = temp_delta->valuedouble;
+	}
+
+	if (hum_delta != NULL) {
+		data->humidity_delta = hum_delta->valuedouble;
+	}
+
+	if (bat_delta != NULL) {
+		data->battery_delta = bat_delta->valueint;
+	}
+
+	if (rsrp_delta != NULL) {
+		data->rsrp_delta = rsrp_delta->valueint;
+	}
+
+	if (max_silence != NULL) {
+		data->max_silence = max_silence->valueint;
+	}
+
 exit:
 	cJSON_Delete(root_obj);
 	return err;
 }
 
 int cloud_codec_encode_config(struct cloud_codec_data *output,
-			      struct cloud_data_cfg *data)
+			      struct cloud_data_cfg *data,
+			      uint32_t fields,
+			      uint32_t version)
 {
 	int err = 0;
 	char *buffer;
@@ -507,18 +826,82 @@ int cloud_codec_encode_config(struct cloud_codec_data *output,
 		return -ENOMEM;
 	}
 
-	err += json_add_bool(cfg_obj, CONFIG_DEVICE_MODE,
-			     data->active_mode);
-	err += json_add_number(cfg_obj, CONFIG_GPS_TIMEOUT,
-			       data->gps_timeout);
-	err += json_add_number(cfg_obj, CONFIG_ACTIVE_TIMEOUT,
-			       data->active_wait_timeout);
-	err += json_add_number(cfg_obj, CONFIG_MOVE_RES,
-			       data->movement_resolution);
-	err += json_add_number(cfg_obj, CONFIG_MOVE_TIMEOUT,
-			       data->movement_timeout);
-	err += json_add_number(cfg_obj, CONFIG_ACC_THRESHOLD,
-			       data->accelerometer_threshold);
+	if (fields & CLOUD_DATA_CFG_ACTIVE_MODE) {
+		err += json_add_bool(cfg_obj, CONFIG_DEVICE_MODE,
+				     data->active_mode);
+	}
+
+	if (fields & CLOUD_DATA_CFG_GPS_TIMEOUT) {
+		err += json_add_number(cfg_obj, CONFIG_GPS_TIMEOUT,
+				       data->gps_timeout);
+	}
+
+	if (fields & CLOUD_DATA_CFG_ACTIVE_WAIT_TIMEOUT) {
+		err += json_add_number(cfg_obj, CONFIG_ACTIVE_TIMEOUT,
+				       data->active_wait_timeout);
+	}
+
+	if (fields & CLOUD_DATA_CFG_MOVEMENT_RESOLUTION) {
+		err += json_add_number(cfg_obj, CONFIG_MOVE_RES,
+				       data->movement_resolution);
+	}
+
+	if (fields & CLOUD_DATA_CFG_MOVEMENT_TIMEOUT) {
+		err += json_add_number(cfg_obj, CONFIG_MOVE_TIMEOUT,
+				       data->movement_timeout);
+	}
+
+	if (fields & CLOUD_DATA_CFG_ACCELEROMETER_THRESHOLD) {
+		err += json_add_number(cfg_obj, CONFIG_ACC_THRESHOLD,
+				       data->accelerometer_threshold);
+	}
+
+	if (fields & CLOUD_DATA_CFG_TRACKING_MODE) {
+		err += json_add_bool(cfg_obj, CONFIG_TRACKING_MODE,
+				     data->tracking_mode);
+	}
+
+	if (fields & CLOUD_DATA_CFG_TRACKING_INTERVAL) {
+		err += json_add_number(cfg_obj, CONFIG_TRACKING_INT,
+				       data->tracking_interval);
+	}
+
+	if (fields & CLOUD_DATA_CFG_TRACKING_DURATION) {
+		err += json_add_number(cfg_obj, CONFIG_TRACKING_DUR,
+				       data->tracking_duration);
+	}
+
+	if (fields & CLOUD_DATA_CFG_TRACKING_START) {
+		err += json_add_number(cfg_obj, CONFIG_TRACKING_START,
+				       data->tracking_start);
+	}
+
+	if (fields & CLOUD_DATA_CFG_TEMPERATURE_DELTA) {
+		err += json_add_number(cfg_obj, CONFIG_TEMP_DELTA,
+				       data->temperature_delta);
+	}
+
+	if (fields & CLOUD_DATA_CFG_HUMIDITY_DELTA) {
+		err += json_add_number(cfg_obj, CONFIG_HUMID_DELTA,
+				       data->humidity_delta);
+	}
+
+	if (fields & CLOUD_DATA_CFG_BATTERY_DELTA) {
+		err += json_add_number(cfg_obj, CONFIG_BAT_DELTA,
+				       data->battery_delta);
+	}
+
+	if (fields & CLOUD_DATA_CFG_RSRP_DELTA) {
+		err += json_add_number(cfg_obj, CONFIG_RSRP_DELTA,
+				       data->rsrp_delta);
+	}
+
+	if (fields & CLOUD_DATA_CFG_MAX_SILENCE) {
+		err += json_add_number(cfg_obj, CONFIG_MAX_SILENCE,
+				       data->max_silence);
+	}
+
+	err += json_add_number(cfg_obj, CONFIG_REPORTED_VERSION, version);
 
 	err += json_add_obj(root_obj, OBJECT_CONFIG, cfg_obj);
 
@@ -547,7 +930,8 @@ int cloud_codec_encode_data(struct cloud_codec_data *output,
 			    struct cloud_data_modem_dynamic *modem_dyn_buf,
 			    struct cloud_data_ui *ui_buf,
 			    struct cloud_data_accelerometer *mov_buf,
-			    struct cloud_data_battery *bat_buf)
+			    struct cloud_data_battery *bat_buf,
+			    struct cloud_data_activity *activity_buf)
 {
 	int err = 0;
 	char *buffer;
@@ -590,6 +974,11 @@ int cloud_codec_encode_data(struct cloud_codec_data *output,
 		data_encoded = true;
 	}
 
+	if (activity_buf->queued) {
+		err += activity_data_add(root_obj, activity_buf, false);
+		data_encoded = true;
+	}
+
 	/* Exit upon encoding errors or no data encoded. */
 	if (err) {
 		goto exit;
@@ -662,12 +1051,16 @@ int cloud_codec_encode_batch_data(
 				struct cloud_data_ui *ui_buf,
 				struct cloud_data_accelerometer *accel_buf,
 				struct cloud_data_battery *bat_buf,
+				struct cloud_data_cell_trail *cell_trail_buf,
+				struct cloud_data_activity *activity_buf,
 				size_t gps_buf_count,
 				size_t sensor_buf_count,
 				size_t modem_dyn_buf_count,
 				size_t ui_buf_count,
 				size_t accel_buf_count,
-				size_t bat_buf_count)
+				size_t bat_buf_count,
+				size_t cell_trail_buf_count,
+				size_t activity_buf_count)
 {
 	int err = 0;
 	char *buffer;
@@ -680,10 +1073,13 @@ int cloud_codec_encode_batch_data(
 	cJSON *ui_obj = cJSON_CreateArray();
 	cJSON *accel_obj = cJSON_CreateArray();
 	cJSON *bat_obj = cJSON_CreateArray();
+	cJSON *cell_trail_obj = cJSON_CreateObject();
+	cJSON *activity_obj = cJSON_CreateArray();
 
 	if (root_obj == NULL || gps_obj == NULL || sensor_obj == NULL ||
 	    modem_obj == NULL || ui_obj == NULL || accel_obj == NULL ||
-	    bat_obj == NULL) {
+	    bat_obj == NULL || cell_trail_obj == NULL ||
+	    activity_obj == NULL) {
 		cJSON_Delete(root_obj);
 		cJSON_Delete(gps_obj);
 		cJSON_Delete(sensor_obj);
@@ -691,6 +1087,8 @@ int cloud_codec_encode_batch_data(
 		cJSON_Delete(ui_obj);
 		cJSON_Delete(accel_obj);
 		cJSON_Delete(bat_obj);
+		cJSON_Delete(cell_trail_obj);
+		cJSON_Delete(activity_obj);
 		return -ENOMEM;
 	}
 
@@ -754,6 +1152,22 @@ int cloud_codec_encode_batch_data(
 		cJSON_Delete(accel_obj);
 	}
 
+	/* Activity data */
+	for (int i = 0; i < activity_buf_count; i++) {
+		if (activity_buf[i].queued) {
+			err += activity_data_add(activity_obj,
+						 &activity_buf[i],
+						 true);
+		}
+	}
+
+	if (cJSON_GetArraySize(activity_obj) > 0) {
+		err += json_add_obj(root_obj, DATA_ACTIVITY, activity_obj);
+		data_encoded = true;
+	} else {
+		cJSON_Delete(activity_obj);
+	}
+
 	/* Battery data */
 	for (int i = 0; i < bat_buf_count; i++) {
 		if (bat_buf[i].queued) {
@@ -784,6 +1198,17 @@ int cloud_codec_encode_batch_data(
 		cJSON_Delete(modem_obj);
 	}
 
+	/* Cell trail */
+	err += cell_trail_data_add(cell_trail_obj, cell_trail_buf,
+				   cell_trail_buf_count);
+
+	if (cJSON_GetArraySize(cell_trail_obj) > 0) {
+		err += json_add_obj(root_obj, DATA_CELL_TRAIL, cell_trail_obj);
+		data_encoded = true;
+	} else {
+		cJSON_Delete(cell_trail_obj);
+	}
+
 	if (err) {
 		goto exit;
 	} else if (!data_encoded) {
@@ -806,3 +1231,46 @@ exit:
 
 	return err;
 }
+
+int cloud_codec_encode_track(struct cloud_codec_data *output,
+			     struct cloud_data_track *track)
+{
+	int err = 0;
+	char *buffer;
+
+	cJSON *root_obj = cJSON_CreateObject();
+	cJSON *trk_obj = cJSON_CreateArray();
+
+	if (root_obj == NULL || trk_obj == NULL) {
+		cJSON_Delete(root_obj);
+		cJSON_Delete(trk_obj);
+		return -ENOMEM;
+	}
+
+	if (!track->queued) {
+		cJSON_Delete(trk_obj);
+		err = -ENODATA;
+		goto exit;
+	}
+
+	err += track_data_add(trk_obj, track);
+	err += json_add_obj(root_obj, DATA_TRACK, trk_obj);
+
+	if (err) {
+		goto exit;
+	}
+
+	buffer = cJSON_PrintUnformatted(root_obj);
+
+	if (IS_ENABLED(CONFIG_CLOUD_CODEC_LOG_LEVEL_DBG)) {
+		json_print_obj("Encoded track message:\n", root_obj);
+	}
+
+	output->buf = buffer;
+	output->len = strlen(buffer);
+
+exit:
+	cJSON_Delete(root_obj);
+
+	return err;
+}
@@ -55,6 +55,12 @@ struct cloud_data_gps {
 	float spd;
 	/** Heading of movement in degrees. */
 	float hdg;
+	/** Flag signifying that the entry is a reused previous fix. */
+	bool reused;
+	/** Age of a reused fix in seconds. */
+	uint32_t age;
+	/** Flag signifying that the position is estimated, not a fix. */
+	bool estimated;
 	/** Flag signifying that the data entry is to be encoded. */
 	bool queued;
 };
@@ -74,17 +80,91 @@ struct cloud_data_cfg {
 	int movement_timeout;
 	/** Accelerometer trigger threshold value in m/s2. */
 	double accelerometer_threshold;
+	/** Tracking mode. Overrides the device mode while enabled. */
+	bool tracking_mode;
+	/** Time between GPS fixes stored in Tracking mode. */
+	int tracking_interval;
+	/** Time before Tracking mode is disabled automatically. */
+	int tracking_duration;
+	/** Minimum temperature change in celsius for a new environmental
+	 *  sample to be stored.
+	 */
+	double temperature_delta;
+	/** Minimum humidity change in percentage for a new environmental
+	 *  sample to be stored.
+	 */
+	double humidity_delta;
+	/** Minimum battery voltage change in mV for a new battery sample to
+	 *  be stored.
+	 */
+	int battery_delta;
+	/** Minimum RSRP change in dB for new dynamic modem data to be stored
+	 *  when the serving cell and network are unchanged.
+	 */
+	int rsrp_delta;
+	/** Time after which a sample is stored even if it is within the
+	 *  dead-band of the last stored sample.
+	 */
+	int max_silence;
+	/** Start of the requested Tracking mode session. UNIX time in seconds,
+	 *  0 if not set.
+	 */
+	int tracking_start;
 };
 
+/** @brief Device configuration fields. Used to select which fields are
+ *	   encoded when the device configuration is reported to cloud.
+ */
+enum cloud_data_cfg_field {
+	CLOUD_DATA_CFG_ACTIVE_MODE		= BIT(0),
+	CLOUD_DATA_CFG_GPS_TIMEOUT		= BIT(1),
+	CLOUD_DATA_CFG_ACTIVE_WAIT_TIMEOUT	= BIT(2),
+	CLOUD_DATA_CFG_MOVEMENT_RESOLUTION	= BIT(3),
+	CLOUD_DATA_CFG_MOVEMENT_TIMEOUT		= BIT(4),
+	CLOUD_DATA_CFG_ACCELEROMETER_THRESHOLD	= BIT(5),
+	CLOUD_DATA_CFG_TRACKING_MODE		= BIT(6),
+	CLOUD_DATA_CFG_TRACKING_INTERVAL	= BIT(7),
+	CLOUD_DATA_CFG_TRACKING_DURATION	= BIT(8),
+	CLOUD_DATA_CFG_TEMPERATURE_DELTA	= BIT(9),
+	CLOUD_DATA_CFG_HUMIDITY_DELTA		= BIT(10),
+	CLOUD_DATA_CFG_BATTERY_DELTA		= BIT(11),
+	CLOUD_DATA_CFG_RSRP_DELTA		= BIT(12),
+	CLOUD_DATA_CFG_MAX_SILENCE		= BIT(13),
+	CLOUD_DATA_CFG_TRACKING_START		= BIT(14)
+};
+
+/** @brief Window of movement, merged from accelerometer triggers. */
 struct cloud_data_accelerometer {
-	/** Accelerometer readings timestamp. UNIX milliseconds. */
+	/** Timestamp of the first trigger in the window. UNIX milliseconds. */
 	int64_t ts;
-	/** Accelerometer readings. */
+	/** Acceleration per axis of the first trigger in the window. */
 	double values[3];
+	/** Largest absolute acceleration per axis in the window. */
+	double peak[3];
+	/** Time from the first to the last trigger in milliseconds. */
+	uint32_t duration;
+	/** Number of triggers in the window. */
+	uint16_t count;
 	/** Flag signifying that the data entry is to be published. */
 	bool queued;
 };
 
+/** @brief Time spent in each activity since the previous entry. */
+struct cloud_data_activity {
+	/** Activity summary timestamp. UNIX milliseconds. */
+	int64_t ts;
+	/** Seconds at rest. */
+	uint16_t rest;
+	/** Seconds walking. */
+	uint16_t walk;
+	/** Seconds running. */
+	uint16_t run;
+	/** Seconds jumping. */
+	uint16_t jump;
+	/** Flag signifying that the data entry is to be encoded. */
+	bool queued;
+};
+
 struct cloud_data_sensors {
 	/** Environmental sensors timestamp. UNIX milliseconds. */
 	int64_t env_ts;
@@ -132,6 +212,14 @@ struct cloud_data_modem_dynamic {
 	char *ip;
 	/* Mobile Country Code*/
 	char *mccmnc;
+	/** RRC connected time per publication in milliseconds. */
+	uint32_t radio_cost;
+	/** RRC connected time in the current 24 hour period in seconds. */
+	uint32_t radio_day;
+	/** Part of radio_day spent in connections without publications. */
+	uint32_t radio_other;
+	/** Flag signifying that the radio times are to be encoded. */
+	bool radio;
 	/** Flag signifying that the data entry is to be encoded. */
 	bool queued;
 };
@@ -145,6 +233,48 @@ struct cloud_data_ui {
 	bool queued;
 };
 
+/** @brief Track point, relative to the previous point of the segment. */
+struct cloud_data_track_point {
+	/** Time since the previous point in units of 100 ms. */
+	uint16_t dt;
+	/** Latitude difference in units of 10^-6 degrees. */
+	int16_t dlat;
+	/** Longitude difference in units of 10^-6 degrees. */
+	int16_t dlng;
+};
+
+/** @brief Segment of a track recorded in Tracking mode. Only the first point
+ *	   is stored with absolute values.
+ */
+struct cloud_data_track {
+	/** Timestamp of the first point. UNIX milliseconds. */
+	int64_t ts;
+	/** Latitude of the first point in units of 10^-6 degrees. */
+	int32_t lat;
+	/** Longitude of the first point in units of 10^-6 degrees. */
+	int32_t lng;
+	/** Points following the first point. */
+	struct cloud_data_track_point *points;
+	/** Number of entries in points. */
+	uint16_t count;
+	/** Flag signifying that the data entry is to be encoded. */
+	bool queued;
+};
+
+/** @brief Serving cell recorded when the device changed cell. */
+struct cloud_data_cell_trail {
+	/** Time of the cell change. UNIX milliseconds. */
+	int64_t ts;
+	/** E-UTRAN cell ID. */
+	uint32_t cell;
+	/** Tracking area code. */
+	uint32_t area;
+	/** RSRP of the new cell in dBm, 0 if unknown. */
+	int16_t rsrp;
+	/** Flag signifying that the data entry is to be encoded. */
+	bool queued;
+};
+
 struct cloud_codec_data {
 	/** Encoded output. */
 	char *buf;
@@ -159,8 +289,23 @@ static inline void cloud_codec_init(void)
 
 int cloud_codec_decode_config(char *input, struct cloud_data_cfg *cfg);
 
+/**
+ * @brief Encode the device configuration.
+ *
+ * @param output Encoded output.
+ * @param cfg Device configuration.
+ * @param fields Bitmask of enum cloud_data_cfg_field. Only the given fields
+ *		 are encoded.
+ * @param version Reported configuration version. Incremented by the caller
+ *		  for every configuration change so that gaps can be detected
+ *		  by the cloud.
+ *
+ * @return 0 on success, otherwise a negative error code.
+ */
 int cloud_codec_encode_config(struct cloud_codec_data *output,
-			      struct cloud_data_cfg *cfg);
+			      struct cloud_data_cfg *cfg,
+			      uint32_t fields,
+			      uint32_t version);
 
 int cloud_codec_encode_data(struct cloud_codec_data *output,
 			    struct cloud_data_gps *gps_buf,
@@ -169,7 +314,8 @@ int cloud_codec_encode_data(struct cloud_codec_data *output,
 			    struct cloud_data_modem_dynamic *modem_dyn_buf,
 			    struct cloud_data_ui *ui_buf,
 			    struct cloud_data_accelerometer *accel_buf,
-			    struct cloud_data_battery *bat_buf);
+			    struct cloud_data_battery *bat_buf,
+			    struct cloud_data_activity *activity_buf);
 
 int cloud_codec_encode_ui_data(struct cloud_codec_data *output,
 			       struct cloud_data_ui *ui_buf);
@@ -182,12 +328,27 @@ int cloud_codec_encode_batch_data(
 				struct cloud_data_ui *ui_buf,
 				struct cloud_data_accelerometer *accel_buf,
 				struct cloud_data_battery *bat_buf,
+				struct cloud_data_cell_trail *cell_trail_buf,
+				struct cloud_data_activity *activity_buf,
 				size_t gps_buf_count,
 				size_t sensor_buf_count,
 				size_t modem_dyn_buf_count,
 				size_t ui_buf_count,
 				size_t accel_buf_count,
-				size_t bat_buf_count);
+				size_t bat_buf_count,
+				size_t cell_trail_buf_count,
+				size_t activity_buf_count);
+
+/**
+ * @brief Encode a track segment.
+ *
+ * @param output Encoded output.
+ * @param track Track segment. Marked as not queued when encoded.
+ *
+ * @return 0 on success, otherwise a negative error code.
+ */
+int cloud_codec_encode_track(struct cloud_codec_data *output,
+			     struct cloud_data_track *track);
 
 void cloud_codec_populate_sensor_buffer(
 				struct cloud_data_sensors *sensor_buffer,
@@ -222,6 +383,18 @@ void cloud_codec_populate_modem_dynamic_buffer(
 				int *head_modem_buf,
 				size_t buffer_count);
 
+void cloud_codec_populate_activity_buffer(
+				struct cloud_data_activity *activity_buffer,
+				struct cloud_data_activity *new_activity_data,
+				int *head_activity_buf,
+				size_t buffer_count);
+
+void cloud_codec_populate_cell_trail_buffer(
+				struct cloud_data_cell_trail *trail_buffer,
+				struct cloud_data_cell_trail *new_trail_data,
+				int *head_cell_trail_buf,
+				size_t buffer_count);
+
 static inline void cloud_codec_release_data(struct cloud_codec_data *output)
 {
 	k_free(output->buf);
@@ -136,3 +136,47 @@ void cloud_codec_populate_modem_dynamic_buffer(
 	LOG_DBG("Entry: %d of %d in dynamic modem buffer filled",
 		*head_modem_buf, buffer_count - 1);
 }
+
+void cloud_codec_populate_activity_buffer(
+				struct cloud_data_activity *activity_buffer,
+				struct cloud_data_activity *new_activity_data,
+				int *head_activity_buf,
+				size_t buffer_count)
+{
+	if (!new_activity_data->queued) {
+		return;
+	}
+
+	/* Go to start of buffer if end is reached. */
+	*head_activity_buf += 1;
+	if (*head_activity_buf == buffer_count) {
+		*head_activity_buf = 0;
+	}
+
+	activity_buffer[*head_activity_buf] = *new_activity_data;
+
+	LOG_DBG("Entry: %d of %d in activity buffer filled",
+		*head_activity_buf, buffer_count - 1);
+}
+
+void cloud_codec_populate_cell_trail_buffer(
+				struct cloud_data_cell_trail *trail_buffer,
+				struct cloud_data_cell_trail *new_trail_data,
+				int *head_cell_trail_buf,
+				size_t buffer_count)
+{
+	if (!new_trail_data->queued) {
+		return;
+	}
+
+	/* Go to start of buffer if end is reached. */
+	*head_cell_trail_buf += 1;
+	if (*head_cell_trail_buf == buffer_count) {
+		*head_cell_trail_buf = 0;
+	}
+
+	trail_buffer[*head_cell_trail_buf] = *new_trail_data;
+
+	LOG_DBG("Entry: %d of %d in cell trail buffer filled",
+		*head_cell_trail_buf, buffer_count - 1);
+}
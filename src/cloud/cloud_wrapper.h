@@ -1,4 +1,12 @@
 #include <zephyr.h>
+#include <net/mqtt.h>
+
+/* QoS used when publishing data, configuration and UI messages. */
+#if defined(CONFIG_CLOUD_QOS_1)
+#define CLOUD_WRAP_DATA_QOS MQTT_QOS_1_AT_LEAST_ONCE
+#else
+#define CLOUD_WRAP_DATA_QOS MQTT_QOS_0_AT_MOST_ONCE
+#endif
 
 enum cloud_wrap_event_type {
 	/* Cloud integration layer is connecting. */
@@ -19,6 +27,8 @@ enum cloud_wrap_event_type {
 	CLOUD_WRAP_EVT_FOTA_ERASE_PENDING,
 	/* Image erase done. */
 	CLOUD_WRAP_EVT_FOTA_ERASE_DONE,
+	/* A message published with QoS 1 has been acknowledged by the broker. */
+	CLOUD_WRAP_EVT_DATA_ACK,
 	/* Irrecoverable error has occurred in the cloud integration layer. */
 	CLOUD_WRAP_EVT_ERROR,
 
@@ -35,6 +45,7 @@ struct cloud_wrap_event {
 	union {
 		struct cloud_wrap_event_data data;
 		int err;
+		uint16_t message_id;
 	};
 };
 
@@ -54,14 +65,19 @@ int cloud_wrap_disconnect(void);
  */
 int cloud_wrap_state_get(void);
 
+/* The functions below publish with CLOUD_WRAP_DATA_QOS. The message ID is
+ * returned in CLOUD_WRAP_EVT_DATA_ACK when the message has been acknowledged.
+ * It must be non-zero if CONFIG_CLOUD_QOS_1 is enabled.
+ */
+
 /* Send data to the device state. */
-int cloud_wrap_state_send(char *buf, size_t len);
+int cloud_wrap_state_send(char *buf, size_t len, uint16_t message_id);
 
 /* Send data to cloud. */
-int cloud_wrap_data_send(char *buf, size_t len);
+int cloud_wrap_data_send(char *buf, size_t len, uint16_t message_id);
 
 /* Send batched data to cloud. */
-int cloud_wrap_batch_send(char *buf, size_t len);
+int cloud_wrap_batch_send(char *buf, size_t len, uint16_t message_id);
 
 /* Send UI data to cloud. Button presses. */
-int cloud_wrap_ui_send(char *buf, size_t len);
+int cloud_wrap_ui_send(char *buf, size_t len, uint16_t message_id);
@@ -21,8 +21,14 @@ static char *get_evt_type_str(enum cloud_module_event_type type)
 		return "CLOUD_EVT_CONNECTION_TIMEOUT";
 	case CLOUD_EVT_CONFIG_RECEIVED:
 		return "CLOUD_EVT_CONFIG_RECEIVED";
+	case CLOUD_EVT_DATA_RECEIVED:
+		return "CLOUD_EVT_DATA_RECEIVED";
 	case CLOUD_EVT_DATA_ACK:
 		return "CLOUD_EVT_DATA_ACK";
+	case CLOUD_EVT_PUBACK:
+		return "CLOUD_EVT_PUBACK";
+	case CLOUD_EVT_UPLINK_DONE:
+		return "CLOUD_EVT_UPLINK_DONE";
 	case CLOUD_EVT_SHUTDOWN_READY:
 		return "CLOUD_EVT_SHUTDOWN_READY";
 	case CLOUD_EVT_FOTA_DONE:
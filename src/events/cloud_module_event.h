@@ -27,8 +27,11 @@ enum cloud_module_event_type {
 	CLOUD_EVT_CONNECTING,
 	CLOUD_EVT_CONNECTION_TIMEOUT,
 	CLOUD_EVT_CONFIG_RECEIVED,
+	CLOUD_EVT_DATA_RECEIVED,
 	CLOUD_EVT_FOTA_DONE,
 	CLOUD_EVT_DATA_ACK,
+	CLOUD_EVT_PUBACK,
+	CLOUD_EVT_UPLINK_DONE,
 	CLOUD_EVT_SHUTDOWN_READY,
 	CLOUD_EVT_ERROR
 };
@@ -47,6 +50,9 @@ struct cloud_module_event {
 		struct cloud_data_cfg config;
 		void *ptr;
 		int err;
+		uint16_t message_id;
+		/* Length of a message received from cloud. */
+		size_t len;
 	} data;
 };
 
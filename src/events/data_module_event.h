@@ -33,9 +33,15 @@ enum data_module_event_type {
 	DATA_EVT_CONFIG_GET,
 	DATA_EVT_SHUTDOWN_READY,
 	DATA_EVT_DATE_TIME_OBTAINED,
+	DATA_EVT_TRACKING_EXPIRED,
 	DATA_EVT_ERROR
 };
 
+/** Maximum number of encoded buffers that the Data module keeps pending until
+ *  they are acknowledged with CLOUD_EVT_DATA_ACK.
+ */
+#define DATA_PENDING_MAX 10
+
 /** Struct containing pointer to array of data elements. */
 struct data_module_data_buffers {
 	char *buf;
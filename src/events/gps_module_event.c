@@ -13,6 +13,8 @@ static char *get_evt_type_str(enum gps_module_event_type type)
 	switch (type) {
 	case GPS_EVT_DATA_READY:
 		return "GPS_EVT_DATA_READY";
+	case GPS_EVT_TRACK_DATA_READY:
+		return "GPS_EVT_TRACK_DATA_READY";
 	case GPS_EVT_TIMEOUT:
 		return "GPS_EVT_TIMEOUT";
 	case GPS_EVT_ACTIVE:
@@ -23,6 +25,8 @@ static char *get_evt_type_str(enum gps_module_event_type type)
 		return "GPS_EVT_SHUTDOWN_READY";
 	case GPS_EVT_AGPS_NEEDED:
 		return "GPS_EVT_AGPS_NEEDED";
+	case GPS_EVT_RRC_IDLE_WAIT_EXPIRED:
+		return "GPS_EVT_RRC_IDLE_WAIT_EXPIRED";
 	case GPS_EVT_ERROR_CODE:
 		return "GPS_EVT_ERROR_CODE";
 	default:
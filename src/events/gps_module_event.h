@@ -24,11 +24,13 @@ extern "C" {
 /** @brief GPS event types submitted by GPS module. */
 enum gps_module_event_type {
 	GPS_EVT_DATA_READY,
+	GPS_EVT_TRACK_DATA_READY,
 	GPS_EVT_TIMEOUT,
 	GPS_EVT_ACTIVE,
 	GPS_EVT_INACTIVE,
 	GPS_EVT_SHUTDOWN_READY,
 	GPS_EVT_AGPS_NEEDED,
+	GPS_EVT_RRC_IDLE_WAIT_EXPIRED,
 	GPS_EVT_ERROR_CODE,
 };
 
@@ -40,6 +42,16 @@ struct gps_module_data {
 	float accuracy;
 	float speed;
 	float heading;
+	/** Set if the fix is a previous fix reused because the device has
+	 *  not moved since it was acquired.
+	 */
+	bool reused;
+	/** Age of a reused fix in seconds. */
+	uint32_t age;
+	/** Set if the position is estimated from earlier fixes and motion.
+	 *  The accuracy is the uncertainty of the estimate.
+	 */
+	bool estimated;
 };
 
 /** @brief GPS event. */
@@ -19,6 +19,12 @@ static char *get_evt_type_str(enum modem_module_event_type type)
 		return "MODEM_EVT_LTE_CONNECTING";
 	case MODEM_EVT_LTE_CELL_UPDATE:
 		return "MODEM_EVT_LTE_CELL_UPDATE";
+	case MODEM_EVT_LTE_RSRP_UPDATE:
+		return "MODEM_EVT_LTE_RSRP_UPDATE";
+	case MODEM_EVT_LTE_RRC_CONNECTED:
+		return "MODEM_EVT_LTE_RRC_CONNECTED";
+	case MODEM_EVT_LTE_RRC_IDLE:
+		return "MODEM_EVT_LTE_RRC_IDLE";
 	case MODEM_EVT_LTE_PSM_UPDATE:
 		return "MODEM_EVT_LTE_PSM_UPDATE";
 	case MODEM_EVT_LTE_EDRX_UPDATE:
@@ -25,6 +25,9 @@ enum modem_module_event_type {
 	MODEM_EVT_LTE_DISCONNECTED,
 	MODEM_EVT_LTE_CONNECTING,
 	MODEM_EVT_LTE_CELL_UPDATE,
+	MODEM_EVT_LTE_RSRP_UPDATE,
+	MODEM_EVT_LTE_RRC_CONNECTED,
+	MODEM_EVT_LTE_RRC_IDLE,
 	MODEM_EVT_LTE_PSM_UPDATE,
 	MODEM_EVT_LTE_EDRX_UPDATE,
 	MODEM_EVT_MODEM_STATIC_DATA_READY,
@@ -71,6 +74,10 @@ struct modem_module_static_modem_data {
 	char *app_version;
 	const char *board_version;
 	char *modem_fw;
+	/** CRC32 of the static modem data. Changes when any of the fields
+	 *  change.
+	 */
+	uint32_t hash;
 };
 
 struct modem_module_dynamic_modem_data {
@@ -80,6 +87,17 @@ struct modem_module_dynamic_modem_data {
 	uint16_t rsrp;
 	char *ip_address;
 	char *mccmnc;
+	/** RRC connected time per publication of the last connection that
+	 *  carried publications, in milliseconds.
+	 */
+	uint32_t radio_cost;
+	/** RRC connected time in the current 24 hour period in seconds. */
+	uint32_t radio_day;
+	/** Part of radio_day spent in connections that carried no
+	 *  publications, such as tracking area updates, paging and
+	 *  downlink only connections.
+	 */
+	uint32_t radio_other;
 };
 
 struct modem_module_battery_data {
@@ -96,6 +114,8 @@ struct modem_module_event {
 		struct modem_module_dynamic_modem_data modem_dynamic;
 		struct modem_module_battery_data bat;
 		struct modem_module_cell cell;
+		/** Serving cell RSRP in dBm. */
+		int rsrp;
 		struct modem_module_psm psm;
 		struct modem_module_edrx edrx;
 		int err;
@@ -13,6 +13,12 @@ static char *get_evt_type_str(enum sensor_module_event_type type)
 	switch (type) {
 	case SENSOR_EVT_MOVEMENT_DATA_READY:
 		return "SENSOR_EVT_MOVEMENT_DATA_READY";
+	case SENSOR_EVT_MOVEMENT_INACTIVITY:
+		return "SENSOR_EVT_MOVEMENT_INACTIVITY";
+	case SENSOR_EVT_MOVEMENT_WINDOW_READY:
+		return "SENSOR_EVT_MOVEMENT_WINDOW_READY";
+	case SENSOR_EVT_ACTIVITY_DATA_READY:
+		return "SENSOR_EVT_ACTIVITY_DATA_READY";
 	case SENSOR_EVT_ENVIRONMENTAL_DATA_READY:
 		return "SENSOR_EVT_ENVIRONMENTAL_DATA_READY";
 	case SENSOR_EVT_ENVIRONMENTAL_NOT_SUPPORTED:
@@ -40,6 +46,12 @@ static int log_event(const struct event_header *eh, char *buf,
 				event->data.accel.values[0],
 				event->data.accel.values[1],
 				event->data.accel.values[2]);
+	} else if (event->type == SENSOR_EVT_MOVEMENT_WINDOW_READY) {
+		return snprintf(buf, buf_len, "%s - Triggers: %d, %lld ms",
+				get_evt_type_str(event->type),
+				event->data.window.count,
+				event->data.window.end -
+				event->data.window.start);
 	}
 
 	return snprintf(buf, buf_len, "%s", get_evt_type_str(event->type));
@@ -24,6 +24,9 @@ extern "C" {
 /** @brief Sensor event types su bmitted by Sensor module. */
 enum sensor_module_event_type {
 	SENSOR_EVT_MOVEMENT_DATA_READY,
+	SENSOR_EVT_MOVEMENT_INACTIVITY,
+	SENSOR_EVT_MOVEMENT_WINDOW_READY,
+	SENSOR_EVT_ACTIVITY_DATA_READY,
 	SENSOR_EVT_ENVIRONMENTAL_DATA_READY,
 	SENSOR_EVT_ENVIRONMENTAL_NOT_SUPPORTED,
 	SENSOR_EVT_SHUTDOWN_READY,
@@ -41,6 +44,33 @@ struct sensor_module_accel_data {
 	double values[ACCELEROMETER_AXIS_COUNT];
 };
 
+/** @brief Time in seconds spent in each activity since the last report. */
+struct sensor_module_activity_data {
+	int64_t timestamp;
+	uint16_t rest;
+	uint16_t walk;
+	uint16_t run;
+	uint16_t jump;
+};
+
+/** @brief Accelerometer triggers merged into one window of movement. */
+struct sensor_module_movement_window_data {
+	/** Uptime of the first and the last trigger in the window. */
+	int64_t start;
+	int64_t end;
+	/** Number of triggers in the window. */
+	uint32_t count;
+	/** Acceleration per axis in m/s2 of the first trigger. */
+	double values[ACCELEROMETER_AXIS_COUNT];
+	/** Largest absolute acceleration per axis in m/s2. */
+	double peak[ACCELEROMETER_AXIS_COUNT];
+};
+
+struct sensor_module_inactivity_data {
+	/** Uptime since when no significant movement has been detected. */
+	int64_t since;
+};
+
 /** @brief Sensor event. */
 struct sensor_module_event {
 	struct event_header header;
@@ -48,6 +78,9 @@ struct sensor_module_event {
 	union {
 		struct sensor_module_data sensors;
 		struct sensor_module_accel_data accel;
+		struct sensor_module_inactivity_data inactivity;
+		struct sensor_module_activity_data activity;
+		struct sensor_module_movement_window_data window;
 		int err;
 	} data;
 };
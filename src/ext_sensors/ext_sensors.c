@@ -5,16 +5,49 @@
 #include "ext_sensors.h"
 #include <stdlib.h>
 
+#if defined(CONFIG_EXTERNAL_SENSORS_ACCEL_FIFO)
+#include <drivers/spi.h>
+#include <math.h>
+#endif
+
 #include <logging/log.h>
 LOG_MODULE_REGISTER(ext_sensors, CONFIG_EXTERNAL_SENSORS_LOG_LEVEL);
 
 /* Convert to s/m2 depending on the maximum measured range used for adxl362. */
 #if defined(CONFIG_ADXL362_ACCEL_RANGE_2G)
 #define ADXL362_RANGE_MAX_M_S2 19.6133
+#define ADXL362_MG_PER_LSB 1
 #elif defined(CONFIG_ADXL362_ACCEL_RANGE_4G)
 #define ADXL362_RANGE_MAX_M_S2 39.2266
+#define ADXL362_MG_PER_LSB 2
 #elif defined(CONFIG_ADXL362_ACCEL_RANGE_8G)
 #define ADXL362_RANGE_MAX_M_S2 78.4532
+#define ADXL362_MG_PER_LSB 4
+#endif
+
+#if defined(CONFIG_EXTERNAL_SENSORS_ACCEL_FIFO)
+#define ADXL362_NODE DT_INST(0, adi_adxl362)
+
+/* ADXL362 SPI commands and registers. The FIFO is not supported by the
+ * sensor driver and is accessed directly on the SPI bus of the device.
+ */
+#define ADXL362_CMD_WRITE_REG		0x0A
+#define ADXL362_CMD_READ_REG		0x0B
+#define ADXL362_CMD_READ_FIFO		0x0D
+#define ADXL362_REG_FIFO_ENTRIES_L	0x0C
+#define ADXL362_REG_FIFO_CONTROL	0x28
+
+/* Stream mode. The oldest entries are discarded when the FIFO is full. */
+#define ADXL362_FIFO_MODE_STREAM	0x02
+
+/* FIFO entries are 16-bit little endian words. Bits 15:14 hold the axis and
+ * bits 13:0 the sign extended sample.
+ */
+#define ADXL362_FIFO_AXIS(entry)	(((entry) >> 14) & 0x03)
+#define ADXL362_FIFO_VALUE(entry)	((int16_t)((entry) << 2) >> 2)
+#define ADXL362_FIFO_ENTRIES_MAX	512
+
+#define GRAVITY_MG_TO_M_S2		(9.80665 / 1000.0)
 #endif
 
 #define ADXL362_THRESHOLD_RESOLUTION_DECIMAL_MAX 2048
@@ -46,8 +79,182 @@ static struct env_sensor accel_sensor = {
 	.dev_name = CONFIG_ACCELEROMETER_DEV_NAME
 };
 
+/* Number of multisensor channels in an environmental snapshot. */
+#define ENV_CHANNELS 4
+
+/* Last environmental snapshot. Reused by callers within the TTL so that
+ * back-to-back requests do not trigger a new measurement, which includes
+ * the slow gas heater cycle of the BME680.
+ */
+static struct ext_sensors_env_snapshot env_snapshot;
+static bool env_snapshot_valid;
+static K_MUTEX_DEFINE(env_snapshot_lock);
+
 static ext_sensor_handler_t m_evt_handler;
 
+#if defined(CONFIG_EXTERNAL_SENSORS_ACCEL_FIFO)
+static const struct device *spi_dev;
+static struct spi_cs_control spi_cs;
+static struct spi_config spi_cfg = {
+	.frequency = DT_PROP(ADXL362_NODE, spi_max_frequency),
+	.operation = SPI_WORD_SET(8) | SPI_TRANSFER_MSB,
+	.slave = DT_REG_ADDR(ADXL362_NODE)
+};
+
+/* Samples of the last FIFO burst, oldest first. */
+static double fifo_samples[CONFIG_EXTERNAL_SENSORS_ACCEL_FIFO_SAMPLES]
+			  [ACCELEROMETER_CHANNELS];
+static uint8_t fifo_buf[CONFIG_EXTERNAL_SENSORS_ACCEL_FIFO_SAMPLES *
+			ACCELEROMETER_CHANNELS * 2];
+
+static int accelerometer_reg_read(uint8_t reg, uint8_t *data, size_t len)
+{
+	uint8_t cmd[] = { ADXL362_CMD_READ_REG, reg };
+	const struct spi_buf tx_buf = { .buf = cmd, .len = sizeof(cmd) };
+	const struct spi_buf rx_buf[] = {
+		{ .buf = NULL, .len = sizeof(cmd) },
+		{ .buf = data, .len = len }
+	};
+	const struct spi_buf_set tx = { .buffers = &tx_buf, .count = 1 };
+	const struct spi_buf_set rx = {
+		.buffers = rx_buf,
+		.count = ARRAY_SIZE(rx_buf)
+	};
+
+	return spi_transceive(spi_dev, &spi_cfg, &tx, &rx);
+}
+
+static int accelerometer_reg_write(uint8_t reg, uint8_t value)
+{
+	uint8_t cmd[] = { ADXL362_CMD_WRITE_REG, reg, value };
+	const struct spi_buf tx_buf = { .buf = cmd, .len = sizeof(cmd) };
+	const struct spi_buf_set tx = { .buffers = &tx_buf, .count = 1 };
+
+	return spi_write(spi_dev, &spi_cfg, &tx);
+}
+
+static int accelerometer_fifo_setup(void)
+{
+	spi_dev = device_get_binding(DT_BUS_LABEL(ADXL362_NODE));
+	if (spi_dev == NULL) {
+		LOG_ERR("Could not get device binding %s",
+			DT_BUS_LABEL(ADXL362_NODE));
+		return -ENODEV;
+	}
+
+#if DT_SPI_DEV_HAS_CS_GPIOS(ADXL362_NODE)
+	spi_cs.gpio_dev =
+		device_get_binding(DT_SPI_DEV_CS_GPIOS_LABEL(ADXL362_NODE));
+	if (spi_cs.gpio_dev == NULL) {
+		LOG_ERR("Could not get device binding %s",
+			DT_SPI_DEV_CS_GPIOS_LABEL(ADXL362_NODE));
+		return -ENODEV;
+	}
+
+	spi_cs.gpio_pin = DT_SPI_DEV_CS_GPIOS_PIN(ADXL362_NODE);
+	spi_cs.gpio_dt_flags = DT_SPI_DEV_CS_GPIOS_FLAGS(ADXL362_NODE);
+	spi_cfg.cs = &spi_cs;
+#endif
+
+	/* Only the X, Y and Z axes are stored, at the configured ODR. */
+	return accelerometer_reg_write(ADXL362_REG_FIFO_CONTROL,
+				       ADXL362_FIFO_MODE_STREAM);
+}
+
+/* Drain the FIFO in one SPI burst. Returns the number of complete XYZ
+ * samples stored in fifo_samples, or a negative error code.
+ */
+static int accelerometer_fifo_read(void)
+{
+	int err;
+	int count = 0;
+	int axis_next = 0;
+	uint8_t entries_raw[2];
+	size_t entries;
+	uint8_t cmd = ADXL362_CMD_READ_FIFO;
+	const struct spi_buf tx_buf = { .buf = &cmd, .len = sizeof(cmd) };
+	const struct spi_buf_set tx = { .buffers = &tx_buf, .count = 1 };
+	struct spi_buf rx_buf[] = {
+		{ .buf = NULL, .len = sizeof(cmd) },
+		{ .buf = fifo_buf, .len = 0 }
+	};
+	const struct spi_buf_set rx = {
+		.buffers = rx_buf,
+		.count = ARRAY_SIZE(rx_buf)
+	};
+
+	err = accelerometer_reg_read(ADXL362_REG_FIFO_ENTRIES_L, entries_raw,
+				     sizeof(entries_raw));
+	if (err) {
+		return err;
+	}
+
+	entries = entries_raw[0] | ((entries_raw[1] & 0x03) << 8);
+	entries = MIN(entries, ADXL362_FIFO_ENTRIES_MAX);
+
+	/* Only the most recent samples are kept if the FIFO holds more than
+	 * fits in the buffer. Older entries are read and discarded first.
+	 */
+	while (entries > 0) {
+		size_t capacity = sizeof(fifo_buf) / 2;
+		size_t len = entries > capacity ?
+			     MIN(entries - capacity, capacity) : entries;
+
+		rx_buf[1].len = len * 2;
+		entries -= len;
+
+		err = spi_transceive(spi_dev, &spi_cfg, &tx, &rx);
+		if (err) {
+			return err;
+		}
+	}
+
+	for (size_t i = 0; i < rx_buf[1].len; i += 2) {
+		uint16_t entry = fifo_buf[i] | (fifo_buf[i + 1] << 8);
+
+		/* Resynchronize on the X axis of the next sample if the burst
+		 * does not start with a complete sample.
+		 */
+		if (ADXL362_FIFO_AXIS(entry) != axis_next) {
+			axis_next = 0;
+
+			if (ADXL362_FIFO_AXIS(entry) != 0) {
+				continue;
+			}
+		}
+
+		fifo_samples[count][axis_next] = ADXL362_FIFO_VALUE(entry) *
+						 ADXL362_MG_PER_LSB *
+						 GRAVITY_MG_TO_M_S2;
+
+		if (++axis_next == ACCELEROMETER_CHANNELS) {
+			axis_next = 0;
+			count++;
+		}
+	}
+
+	return count;
+}
+
+/* Report the sample with the largest absolute axis value in the block, which
+ * is the sample that triggered the threshold.
+ */
+static void accelerometer_fifo_peak_get(int count, double values[])
+{
+	double peak = -1.0;
+
+	for (int i = 0; i < count; i++) {
+		for (int j = 0; j < ACCELEROMETER_CHANNELS; j++) {
+			if (fabs(fifo_samples[i][j]) > peak) {
+				peak = fabs(fifo_samples[i][j]);
+				memcpy(values, fifo_samples[i],
+				       sizeof(fifo_samples[i]));
+			}
+		}
+	}
+}
+#endif
+
 static void accelerometer_trigger_handler(const struct device *dev,
 					  struct sensor_trigger *trig)
 {
@@ -67,6 +274,17 @@ static void accelerometer_trigger_handler(const struct device *dev,
 			break;
 		}
 
+#if defined(CONFIG_EXTERNAL_SENSORS_ACCEL_FIFO)
+		err = accelerometer_fifo_read();
+		if (err > 0) {
+			evt.samples = fifo_samples;
+			evt.sample_count = err;
+			accelerometer_fifo_peak_get(err, evt.value_array);
+			goto filter;
+		} else if (err < 0) {
+			LOG_WRN("FIFO read error: %d, reading one sample", err);
+		}
+#endif
 		if (sensor_sample_fetch(dev) < 0) {
 			LOG_ERR("Sample fetch error");
 			return;
@@ -84,7 +302,12 @@ static void accelerometer_trigger_handler(const struct device *dev,
 		evt.value_array[0] = sensor_value_to_double(&data[0]);
 		evt.value_array[1] = sensor_value_to_double(&data[1]);
 		evt.value_array[2] = sensor_value_to_double(&data[2]);
+		evt.samples = &evt.value_array;
+		evt.sample_count = 1;
 
+#if defined(CONFIG_EXTERNAL_SENSORS_ACCEL_FIFO)
+filter:
+#endif
 		/* Do a soft filter here to avoid sending data triggered by
 		 * the inactivity threshold.
 		 */
@@ -94,6 +317,9 @@ static void accelerometer_trigger_handler(const struct device *dev,
 
 			evt.type = EXT_SENSOR_EVT_ACCELEROMETER_TRIGGER;
 			m_evt_handler(&evt);
+		} else {
+			evt.type = EXT_SENSOR_EVT_ACCELEROMETER_INACTIVITY;
+			m_evt_handler(&evt);
 		}
 
 		break;
@@ -130,6 +356,15 @@ int ext_sensors_init(ext_sensor_handler_t handler)
 		return -ENODATA;
 	}
 
+#if defined(CONFIG_EXTERNAL_SENSORS_ACCEL_FIFO)
+	int err = accelerometer_fifo_setup();
+
+	if (err) {
+		LOG_ERR("Could not enable accelerometer FIFO, error: %d", err);
+		return err;
+	}
+#endif
+
 	struct sensor_trigger trig = { .chan = SENSOR_CHAN_ACCEL_XYZ };
 
 	trig.type = SENSOR_TRIG_THRESHOLD;
@@ -145,10 +380,19 @@ int ext_sensors_init(ext_sensor_handler_t handler)
 	return 0;
 }
 
-int ext_sensors_temperature_get(double *ext_temp)
+/* Fetches all channels of the multisensor in one measurement and converts
+ * them. Must be called with env_snapshot_lock held.
+ */
+static int env_snapshot_fetch(void)
 {
 	int err;
-	struct sensor_value data;
+	struct sensor_value data[ENV_CHANNELS];
+	static const enum sensor_channel channels[ENV_CHANNELS] = {
+		SENSOR_CHAN_AMBIENT_TEMP,
+		SENSOR_CHAN_HUMIDITY,
+		SENSOR_CHAN_PRESS,
+		SENSOR_CHAN_GAS_RES
+	};
 
 	err = sensor_sample_fetch_chan(temp_sensor.dev, SENSOR_CHAN_ALL);
 	if (err) {
@@ -157,42 +401,80 @@ int ext_sensors_temperature_get(double *ext_temp)
 		return -ENODATA;
 	}
 
-	err = sensor_channel_get(temp_sensor.dev, temp_sensor.channel, &data);
-	if (err) {
-		LOG_ERR("Failed to fetch data from %s, error: %d",
-			log_strdup(temp_sensor.dev_name), err);
-		return -ENODATA;
+	for (size_t i = 0; i < ENV_CHANNELS; i++) {
+		err = sensor_channel_get(temp_sensor.dev, channels[i],
+					 &data[i]);
+		if (err) {
+			LOG_ERR("Failed to fetch data from %s, error: %d",
+				log_strdup(temp_sensor.dev_name), err);
+			return -ENODATA;
+		}
 	}
 
-	k_spinlock_key_t key = k_spin_lock(&(temp_sensor.lock));
-	*ext_temp = sensor_value_to_double(&data);
-	k_spin_unlock(&(temp_sensor.lock), key);
+	env_snapshot.temperature = sensor_value_to_double(&data[0]);
+	env_snapshot.humidity = sensor_value_to_double(&data[1]);
+	env_snapshot.pressure = sensor_value_to_double(&data[2]);
+	env_snapshot.gas_resistance = sensor_value_to_double(&data[3]);
+	env_snapshot.timestamp = k_uptime_get();
+	env_snapshot_valid = true;
 
 	return 0;
 }
 
-int ext_sensors_humidity_get(double *ext_hum)
+int ext_sensors_env_snapshot_get(struct ext_sensors_env_snapshot *snapshot)
+{
+	int err = 0;
+
+	if (snapshot == NULL) {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&env_snapshot_lock, K_FOREVER);
+
+	if (!env_snapshot_valid ||
+	    (k_uptime_get() - env_snapshot.timestamp >
+	     CONFIG_EXTERNAL_SENSORS_ENV_SNAPSHOT_TTL)) {
+		err = env_snapshot_fetch();
+	} else {
+		LOG_DBG("Using environmental snapshot from %d ms ago",
+			(int)(k_uptime_get() - env_snapshot.timestamp));
+	}
+
+	if (!err) {
+		*snapshot = env_snapshot;
+	}
+
+	k_mutex_unlock(&env_snapshot_lock);
+
+	return err;
+}
+
+int ext_sensors_temperature_get(double *ext_temp)
 {
 	int err;
-	struct sensor_value data;
+	struct ext_sensors_env_snapshot snapshot;
 
-	err = sensor_sample_fetch_chan(humid_sensor.dev, SENSOR_CHAN_ALL);
+	err = ext_sensors_env_snapshot_get(&snapshot);
 	if (err) {
-		LOG_ERR("Failed to fetch data from %s, error: %d",
-			log_strdup(humid_sensor.dev_name), err);
-		return -ENODATA;
+		return err;
 	}
 
-	err = sensor_channel_get(humid_sensor.dev, humid_sensor.channel, &data);
+	*ext_temp = snapshot.temperature;
+
+	return 0;
+}
+
+int ext_sensors_humidity_get(double *ext_hum)
+{
+	int err;
+	struct ext_sensors_env_snapshot snapshot;
+
+	err = ext_sensors_env_snapshot_get(&snapshot);
 	if (err) {
-		LOG_ERR("Failed to fetch data from %s, error: %d",
-			log_strdup(humid_sensor.dev_name), err);
-		return -ENODATA;
+		return err;
 	}
 
-	k_spinlock_key_t key = k_spin_lock(&(humid_sensor.lock));
-	*ext_hum = sensor_value_to_double(&data);
-	k_spin_unlock(&(humid_sensor.lock), key);
+	*ext_hum = snapshot.humidity;
 
 	return 0;
 }
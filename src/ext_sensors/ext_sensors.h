@@ -28,6 +28,7 @@ extern "C" {
 /** @brief Enum containing callback events from library. */
 enum ext_sensor_evt_type {
 	EXT_SENSOR_EVT_ACCELEROMETER_TRIGGER,
+	EXT_SENSOR_EVT_ACCELEROMETER_INACTIVITY,
 };
 
 /** @brief Structure containing external sensor data. */
@@ -41,6 +42,30 @@ struct ext_sensor_evt {
 		/** Single external sensor value. */
 		double value;
 	};
+	/** Accelerometer samples, oldest first, that are reported with
+	 *  EXT_SENSOR_EVT_ACCELEROMETER_TRIGGER. Read from the accelerometer
+	 *  FIFO if enabled, otherwise the sample in value_array. Only valid
+	 *  in the event handler.
+	 */
+	const double (*samples)[ACCELEROMETER_CHANNELS];
+	/** Number of entries in samples. */
+	size_t sample_count;
+};
+
+/** @brief Structure containing one measurement of all environmental
+ *	   channels of the multisensor.
+ */
+struct ext_sensors_env_snapshot {
+	/** Temperature in celsius. */
+	double temperature;
+	/** Relative humidity in percentage. */
+	double humidity;
+	/** Pressure in kilopascal. */
+	double pressure;
+	/** Gas resistance in ohm. */
+	double gas_resistance;
+	/** Uptime in milliseconds when the measurement was fetched. */
+	int64_t timestamp;
 };
 
 /** @brief External sensors library asynchronous event handler.
@@ -59,6 +84,19 @@ typedef void (*ext_sensor_handler_t)(
  */
 int ext_sensors_init(ext_sensor_handler_t handler);
 
+/**
+ * @brief Get temperature, humidity, pressure and gas resistance from one
+ *	  measurement of the multisensor. A measurement that is younger than
+ *	  CONFIG_EXTERNAL_SENSORS_ENV_SNAPSHOT_TTL is returned without fetching
+ *	  new data from the sensor.
+ *
+ * @param[out] snapshot Pointer to structure that is filled with the
+ *			measurement.
+ *
+ * @return 0 on success or negative error value on failure.
+ */
+int ext_sensors_env_snapshot_get(struct ext_sensors_env_snapshot *snapshot);
+
 /**
  * @brief Get temperature from library.
  *
@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+#include <zephyr.h>
+#include <settings/settings.h>
+#include "location_cache.h"
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(location_cache, CONFIG_LOCATION_CACHE_LOG_LEVEL);
+
+#define LOCATION_CACHE_SETTINGS_KEY	"location_cache"
+#define LOCATION_CACHE_TABLE_KEY	"table"
+
+/* Offset that maps RSRP in dBm to a non-negative value. */
+#define RSRP_OFFSET_DBM 140
+
+struct entry {
+	bool valid;
+	uint8_t rsrp_band;
+	uint32_t cell_id;
+	uint32_t tac;
+	/* Value of use_count when the entry was last stored or looked up. */
+	uint32_t last_used;
+	struct location_cache_position position;
+};
+
+/* The table is only accessed from the GPS module thread and is stored to
+ * flash as one settings entry.
+ */
+static struct entry table[CONFIG_LOCATION_CACHE_ENTRIES];
+static uint32_t use_count;
+
+static struct {
+	uint32_t lookups;
+	uint32_t hits;
+} stats;
+
+static int settings_set(const char *key, size_t len,
+			settings_read_cb read_cb, void *cb_arg)
+{
+	int err;
+
+	if (strcmp(key, LOCATION_CACHE_TABLE_KEY) != 0) {
+		return 0;
+	}
+
+	if (len != sizeof(table)) {
+		LOG_WRN("Cached table size mismatch, discarded");
+		return 0;
+	}
+
+	err = read_cb(cb_arg, table, sizeof(table));
+	if (err < 0) {
+		LOG_ERR("Failed to load location cache, error: %d", err);
+		return err;
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(table); i++) {
+		use_count = MAX(use_count, table[i].last_used);
+	}
+
+	return 0;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(location_cache, LOCATION_CACHE_SETTINGS_KEY,
+			       NULL, settings_set, NULL, NULL);
+
+static uint8_t rsrp_band(int rsrp)
+{
+	return MAX(rsrp + RSRP_OFFSET_DBM, 0) / CONFIG_LOCATION_CACHE_RSRP_BAND;
+}
+
+static struct entry *entry_find(const struct location_cache_cell *cell)
+{
+	uint8_t band = rsrp_band(cell->rsrp);
+
+	for (size_t i = 0; i < ARRAY_SIZE(table); i++) {
+		if (table[i].valid && (table[i].cell_id == cell->cell_id) &&
+		    (table[i].tac == cell->tac) &&
+		    (table[i].rsrp_band == band)) {
+			return &table[i];
+		}
+	}
+
+	return NULL;
+}
+
+/* Free entry, or the least recently used entry if the table is full. */
+static struct entry *entry_replace(void)
+{
+	struct entry *lru = &table[0];
+
+	for (size_t i = 0; i < ARRAY_SIZE(table); i++) {
+		if (!table[i].valid) {
+			return &table[i];
+		}
+
+		if (table[i].last_used < lru->last_used) {
+			lru = &table[i];
+		}
+	}
+
+	LOG_DBG("Replacing location of cell %d", lru->cell_id);
+
+	return lru;
+}
+
+int location_cache_save(void)
+{
+	int err;
+
+	err = settings_save_one(LOCATION_CACHE_SETTINGS_KEY "/"
+				LOCATION_CACHE_TABLE_KEY,
+				table, sizeof(table));
+	if (err) {
+		LOG_WRN("settings_save_one, error: %d", err);
+		return err;
+	}
+
+	return 0;
+}
+
+int location_cache_init(void)
+{
+	int err;
+
+	err = settings_subsys_init();
+	if (err) {
+		LOG_ERR("settings_subsys_init, error: %d", err);
+		return err;
+	}
+
+	err = settings_load_subtree(LOCATION_CACHE_SETTINGS_KEY);
+	if (err) {
+		LOG_ERR("settings_load_subtree, error: %d", err);
+		return err;
+	}
+
+	return 0;
+}
+
+void location_cache_store(const struct location_cache_cell *cell,
+			  const struct location_cache_position *position)
+{
+	struct entry *entry;
+
+	if (position->accuracy > CONFIG_LOCATION_CACHE_ACCURACY_MAX) {
+		return;
+	}
+
+	entry = entry_find(cell);
+	if (entry != NULL) {
+		/* Known cells are only updated in RAM to limit flash wear.
+		 * They are written to flash with location_cache_save().
+		 */
+		entry->position = *position;
+		entry->last_used = ++use_count;
+		return;
+	}
+
+	entry = entry_replace();
+	*entry = (struct entry) {
+		.valid = true,
+		.rsrp_band = rsrp_band(cell->rsrp),
+		.cell_id = cell->cell_id,
+		.tac = cell->tac,
+		.last_used = ++use_count,
+		.position = *position
+	};
+
+	LOG_DBG("Location of cell %d, RSRP %d dBm cached", cell->cell_id,
+		cell->rsrp);
+
+	location_cache_save();
+}
+
+int location_cache_lookup(const struct location_cache_cell *cell,
+			  struct location_cache_position *position)
+{
+	struct entry *entry = entry_find(cell);
+
+	stats.lookups++;
+
+	if (entry != NULL) {
+		stats.hits++;
+		entry->last_used = ++use_count;
+		*position = entry->position;
+	}
+
+	LOG_INF("Location cache %s, hit rate: %d%% (%d of %d)",
+		entry != NULL ? "hit" : "miss",
+		stats.hits * 100 / stats.lookups, stats.hits, stats.lookups);
+
+	return entry != NULL ? 0 : -ENOENT;
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+/**@file
+ *@brief Location cache library header.
+ */
+
+#ifndef LOCATION_CACHE_H__
+#define LOCATION_CACHE_H__
+
+#include <zephyr.h>
+
+/**@file
+ *
+ * @defgroup location_cache Location cache
+ * @brief    Module that caches GPS fixes per serving cell.
+ * @{
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Serving cell fingerprint. */
+struct location_cache_cell {
+	/** E-UTRAN cell ID. */
+	uint32_t cell_id;
+	/** Tracking area code. */
+	uint32_t tac;
+	/** Serving cell RSRP in dBm. */
+	int rsrp;
+};
+
+/** @brief Cached position. */
+struct location_cache_position {
+	double latitude;
+	double longitude;
+	float altitude;
+	float accuracy;
+	/** Time of the fix. UNIX milliseconds, 0 if unknown. */
+	int64_t time;
+};
+
+/**
+ * @brief Initialize the library and load cached locations from flash.
+ *
+ * @return 0 on success or negative error value on failure.
+ */
+int location_cache_init(void);
+
+/**
+ * @brief Store a GPS fix for the given cell. Fixes with an accuracy worse
+ *	  than CONFIG_LOCATION_CACHE_ACCURACY_MAX are ignored. The cache is
+ *	  written to flash when a new cell is added.
+ *
+ * @param[in] cell Serving cell when the fix was acquired.
+ * @param[in] position GPS fix.
+ */
+void location_cache_store(const struct location_cache_cell *cell,
+			  const struct location_cache_position *position);
+
+/**
+ * @brief Look up the cached position for the given cell.
+ *
+ * @param[in] cell Current serving cell.
+ * @param[out] position Cached position.
+ *
+ * @return 0 on success, -ENOENT if no position is cached for the cell.
+ */
+int location_cache_lookup(const struct location_cache_cell *cell,
+			  struct location_cache_position *position);
+
+/**
+ * @brief Write the cache, including the usage order, to flash.
+ *
+ * @return 0 on success or negative error value on failure.
+ */
+int location_cache_save(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @}
+ */
+
+#endif /* LOCATION_CACHE_H__ */
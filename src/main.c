@@ -65,6 +65,7 @@ static enum state_type {
 static enum sub_state_type {
 	SUB_STATE_ACTIVE_MODE,
 	SUB_STATE_PASSIVE_MODE,
+	SUB_STATE_TRACKING_MODE,
 } sub_state;
 
 /* Internal copy of the device configuration. */
@@ -123,6 +124,8 @@ static char *sub_state2str(enum sub_state_type new_state)
 		return "SUB_STATE_ACTIVE_MODE";
 	case SUB_STATE_PASSIVE_MODE:
 		return "SUB_STATE_PASSIVE_MODE";
+	case SUB_STATE_TRACKING_MODE:
+		return "SUB_STATE_TRACKING_MODE";
 	default:
 		return "Unknown";
 	}
@@ -163,6 +166,7 @@ static bool event_handler(const struct event_header *eh)
 {
 	struct app_msg_data msg = {0};
 	bool enqueue_msg = false;
+	uint32_t start = k_cycle_get_32();
 
 	if (is_cloud_module_event(eh)) {
 		struct cloud_module_event *evt = cast_cloud_module_event(eh);
@@ -222,6 +226,8 @@ static bool event_handler(const struct event_header *eh)
 		}
 	}
 
+	module_handler_stats_update(&self, start);
+
 	return false;
 }
 
@@ -276,6 +282,22 @@ static void data_get_all(void)
 	EVENT_SUBMIT(app_module_event);
 }
 
+/* Tracking mode overrides the device mode. Data is sampled and published at
+ * the Active wait timeout interval while the GPS module records the track.
+ */
+static void tracking_mode_enter(void)
+{
+	LOG_INF("Device mode: Tracking");
+	LOG_INF("Start data sample timer: %d seconds interval",
+		app_cfg.active_wait_timeout);
+
+	k_timer_start(&data_sample_timer,
+		      K_SECONDS(app_cfg.active_wait_timeout),
+		      K_SECONDS(app_cfg.active_wait_timeout));
+	k_timer_stop(&movement_timeout_timer);
+	sub_state_set(SUB_STATE_TRACKING_MODE);
+}
+
 /* Message handler for STATE_INIT. */
 static void on_state_init(struct app_msg_data *msg)
 {
@@ -325,6 +347,11 @@ void on_sub_state_passive(struct app_msg_data *msg)
 		/* Keep a copy of the new configuration. */
 		app_cfg = msg->module.data.data.cfg;
 
+		if (app_cfg.tracking_mode) {
+			tracking_mode_enter();
+			return;
+		}
+
 		if (app_cfg.active_mode) {
 			LOG_INF("Device mode: Active");
 			LOG_INF("Start data sample timer: %d seconds interval",
@@ -385,6 +412,11 @@ static void on_sub_state_active(struct app_msg_data *msg)
 		/* Keep a copy of the new configuration. */
 		app_cfg = msg->module.data.data.cfg;
 
+		if (app_cfg.tracking_mode) {
+			tracking_mode_enter();
+			return;
+		}
+
 		if (!app_cfg.active_mode) {
 			LOG_INF("Device mode: Passive");
 			LOG_INF("Start movement timeout: %d seconds interval",
@@ -408,6 +440,41 @@ static void on_sub_state_active(struct app_msg_data *msg)
 	}
 }
 
+/* Message handler for SUB_STATE_TRACKING_MODE. */
+static void on_sub_state_tracking(struct app_msg_data *msg)
+{
+	if (IS_EVENT(msg, data, DATA_EVT_CONFIG_READY)) {
+		/* Keep a copy of the new configuration. */
+		app_cfg = msg->module.data.data.cfg;
+
+		if (app_cfg.tracking_mode) {
+			tracking_mode_enter();
+			return;
+		}
+
+		if (app_cfg.active_mode) {
+			LOG_INF("Device mode: Active");
+			LOG_INF("Start data sample timer: %d seconds interval",
+				app_cfg.active_wait_timeout);
+			k_timer_start(&data_sample_timer,
+				      K_SECONDS(app_cfg.active_wait_timeout),
+				      K_SECONDS(app_cfg.active_wait_timeout));
+			sub_state_set(SUB_STATE_ACTIVE_MODE);
+			return;
+		}
+
+		LOG_INF("Device mode: Passive");
+		LOG_INF("Start movement timeout: %d seconds interval",
+			app_cfg.movement_timeout);
+
+		k_timer_start(&movement_timeout_timer,
+			      K_SECONDS(app_cfg.movement_timeout),
+			      K_SECONDS(app_cfg.movement_timeout));
+		k_timer_stop(&data_sample_timer);
+		sub_state_set(SUB_STATE_PASSIVE_MODE);
+	}
+}
+
 /* Message handler for all states. */
 static void on_all_events(struct app_msg_data *msg)
 {
@@ -462,6 +529,9 @@ void main(void)
 			case SUB_STATE_PASSIVE_MODE:
 				on_sub_state_passive(&msg);
 				break;
+			case SUB_STATE_TRACKING_MODE:
+				on_sub_state_tracking(&msg);
+				break;
 			default:
 				LOG_WRN("Unknown application sub state");
 				break;
@@ -10,10 +10,19 @@
 #include <dfu/mcuboot.h>
 #include <math.h>
 #include <event_manager.h>
+#include <modem/at_cmd.h>
 
 #include "cloud_wrapper.h"
 #include "cloud/cloud_codec/cloud_codec.h"
 
+#if defined(CONFIG_AGPS_CACHE)
+#include "agps_cache.h"
+#endif
+
+#if defined(CONFIG_CLOUD_QOS_1)
+#include "qos_list.h"
+#endif
+
 #define MODULE cloud_module
 
 #include "modules_common.h"
@@ -71,6 +80,70 @@ static struct cloud_backoff_delay_lookup backoff_delay[] = {
  */
 static int connect_retries;
 
+/* Type of message sent to cloud. Selects the cloud wrapper API used. */
+enum send_type {
+	SEND_TYPE_DATA,
+	SEND_TYPE_CONFIG,
+	SEND_TYPE_BATCH,
+	SEND_TYPE_UI
+};
+
+#if defined(CONFIG_CLOUD_QOS_1)
+/* Unacknowledged messages in publication order. The list holds as many
+ * entries as the Data module can have buffers pending.
+ */
+static struct qos_list_msg qos_msgs[DATA_PENDING_MAX];
+static struct qos_list qos_list;
+#endif /* CONFIG_CLOUD_QOS_1 */
+
+#if defined(CONFIG_CLOUD_RAI)
+/* Release Assistance Indication. It is set before the last queued
+ * publication is transmitted, telling the network that only one downlink
+ * message, the PUBACK, is expected after it. The network can then release
+ * the RRC connection without waiting for its inactivity timer. The setting
+ * applies to every following uplink until it is cleared.
+ */
+#define RAI_AT_CMD_ONE_RESPONSE	"AT%XRAI=3"
+#define RAI_AT_CMD_CLEAR	"AT%XRAI=0"
+
+static struct {
+	/* Set when RAI is not used, either because the modem rejected the
+	 * command or because the network ignored it too many times.
+	 */
+	bool disabled;
+	/* Set while the indication is set in the modem. */
+	bool set;
+	/* Uptime when the publication carrying the indication was
+	 * acknowledged, 0 if none since the last RRC release.
+	 */
+	int64_t done;
+	/* Consecutive indications that were not followed by an RRC
+	 * release.
+	 */
+	uint8_t ignored;
+} rai;
+#endif
+
+#if defined(CONFIG_CLOUD_DEFER_DURING_GPS_SEARCH)
+/* Message held back while a GPS search is active. */
+struct deferred_msg {
+	enum send_type type;
+	char *buf;
+	size_t len;
+};
+
+static struct deferred_msg deferred_list[DATA_PENDING_MAX];
+static size_t deferred_count;
+
+/* Set while the GPS module is searching for a fix. */
+static bool gps_active;
+
+/* Set if a cloud connection attempt has been postponed until the GPS search
+ * has ended.
+ */
+static bool connect_pending;
+#endif /* CONFIG_CLOUD_DEFER_DURING_GPS_SEARCH */
+
 /* Local copy of the device configuration. */
 static struct cloud_data_cfg copy_cfg;
 const k_tid_t cloud_module_thread;
@@ -90,6 +163,7 @@ static struct module_data self = {
 /* Forward declarations. */
 static void connect_check_work_fn(struct k_work *work);
 static void send_config_received(void);
+static void send_data_received(size_t len);
 
 /* Convenience functions used in internal state handling. */
 static char *state2str(enum state_type state)
@@ -149,6 +223,7 @@ static bool event_handler(const struct event_header *eh)
 {
 	struct cloud_msg_data msg = {0};
 	bool enqueue_msg = false;
+	uint32_t start = k_cycle_get_32();
 
 	if (is_app_module_event(eh)) {
 		struct app_module_event *evt = cast_app_module_event(eh);
@@ -201,6 +276,8 @@ static bool event_handler(const struct event_header *eh)
 		}
 	}
 
+	module_handler_stats_update(&self, start);
+
 	return false;
 }
 
@@ -227,6 +304,11 @@ static void cloud_wrap_event_handler(const struct cloud_wrap_event *const evt)
 
 		int err;
 
+		/* Configuration, shadow and A-GPS messages are all counted as
+		 * downlink traffic by the modem module.
+		 */
+		send_data_received(evt->data.len);
+
 		/* Use the config copy when populating the config variable
 		 * before it is sent to the Data module. This way we avoid
 		 * sending uninitialized variables to the Data module.
@@ -246,7 +328,12 @@ static void cloud_wrap_event_handler(const struct cloud_wrap_event *const evt)
 			break;
 		}
 
-#if defined(CONFIG_AGPS)
+#if defined(CONFIG_AGPS_CACHE)
+		err = agps_cache_data_process(evt->data.buf, evt->data.len);
+		if (err) {
+			LOG_WRN("Unable to process agps data, error: %d", err);
+		}
+#elif defined(CONFIG_AGPS)
 		err = gps_process_agps_data(evt->data.buf, evt->data.len);
 		if (err) {
 			LOG_WRN("Unable to process agps data, error: %d", err);
@@ -260,6 +347,11 @@ static void cloud_wrap_event_handler(const struct cloud_wrap_event *const evt)
 	}
 	case CLOUD_WRAP_EVT_FOTA_START: {
 		LOG_DBG("CLOUD_WRAP_EVT_FOTA_START");
+
+		/* The FOTA job document is handled by the cloud library, its
+		 * length is not known.
+		 */
+		send_data_received(0);
 		break;
 	}
 	case CLOUD_WRAP_EVT_FOTA_ERASE_PENDING:
@@ -268,6 +360,20 @@ static void cloud_wrap_event_handler(const struct cloud_wrap_event *const evt)
 	case CLOUD_WRAP_EVT_FOTA_ERASE_DONE:
 		LOG_DBG("CLOUD_WRAP_EVT_FOTA_ERASE_DONE");
 		break;
+	case CLOUD_WRAP_EVT_DATA_ACK: {
+		LOG_DBG("CLOUD_WRAP_EVT_DATA_ACK");
+
+#if defined(CONFIG_CLOUD_QOS_1)
+		struct cloud_module_event *cloud_module_event =
+				new_cloud_module_event();
+
+		cloud_module_event->type = CLOUD_EVT_PUBACK;
+		cloud_module_event->data.message_id = evt->message_id;
+
+		EVENT_SUBMIT(cloud_module_event);
+#endif
+		break;
+	}
 	case CLOUD_WRAP_EVT_ERROR: {
 		LOG_DBG("CLOUD_WRAP_EVT_ERROR");
 		SEND_ERROR(cloud, CLOUD_EVT_ERROR, evt->err);
@@ -302,80 +408,242 @@ static void send_config_received(void)
 	EVENT_SUBMIT(cloud_module_event);
 }
 
-static void data_send(struct data_module_event *evt)
+static void send_data_received(size_t len)
+{
+	struct cloud_module_event *cloud_module_event =
+			new_cloud_module_event();
+
+	cloud_module_event->type = CLOUD_EVT_DATA_RECEIVED;
+	cloud_module_event->data.len = len;
+
+	EVENT_SUBMIT(cloud_module_event);
+}
+
+static void config_get(void)
 {
 	int err;
 
-	err = cloud_wrap_data_send(evt->data.buffer.buf, evt->data.buffer.len);
+	err = cloud_wrap_state_get();
 	if (err) {
-		LOG_ERR("cloud_wrap_data_send, err: %d", err);
+		LOG_ERR("cloud_wrap_state_get, err: %d", err);
 	} else {
-		LOG_DBG("Data sent");
+		LOG_DBG("Device configuration requested");
 	}
+}
 
-	if (evt->data.buffer.len > 0) {
-		send_data_ack(evt->data.buffer.buf);
+static char *send_type2str(enum send_type type)
+{
+	switch (type) {
+	case SEND_TYPE_DATA:
+		return "Data";
+	case SEND_TYPE_CONFIG:
+		return "Configuration";
+	case SEND_TYPE_BATCH:
+		return "Batch";
+	case SEND_TYPE_UI:
+		return "UI";
+	default:
+		return "Unknown";
 	}
 }
 
-static void config_send(struct data_module_event *evt)
+static int wrap_send(enum send_type type, char *buf, size_t len,
+		     uint16_t message_id)
+{
+	switch (type) {
+	case SEND_TYPE_DATA:
+		return cloud_wrap_data_send(buf, len, message_id);
+	case SEND_TYPE_CONFIG:
+		return cloud_wrap_state_send(buf, len, message_id);
+	case SEND_TYPE_BATCH:
+		return cloud_wrap_batch_send(buf, len, message_id);
+	case SEND_TYPE_UI:
+		return cloud_wrap_ui_send(buf, len, message_id);
+	default:
+		return -EINVAL;
+	}
+}
+
+#if defined(CONFIG_CLOUD_QOS_1)
+#if defined(CONFIG_CLOUD_RAI)
+static void rai_set(bool set)
 {
 	int err;
 
-	err = cloud_wrap_state_send(evt->data.buffer.buf, evt->data.buffer.len);
+	if (rai.disabled || (set == rai.set)) {
+		return;
+	}
+
+	err = at_cmd_write(set ? RAI_AT_CMD_ONE_RESPONSE : RAI_AT_CMD_CLEAR,
+			   NULL, 0, NULL);
 	if (err) {
-		LOG_ERR("cloud_wrap_state_send, err: %d", err);
-	} else {
-		LOG_DBG("Data sent");
+		LOG_WRN("RAI not supported, error: %d", err);
+		LOG_WRN("Waiting for the network inactivity timer instead");
+		rai.disabled = true;
+		return;
 	}
 
-	if (evt->data.buffer.len > 0) {
-		send_data_ack(evt->data.buffer.buf);
+	rai.set = set;
+
+	LOG_DBG("RAI %s", set ? "set" : "cleared");
+}
+
+/* Check whether the RRC connection was released right after the
+ * publication carrying the indication was acknowledged.
+ */
+static void rai_release_check(void)
+{
+	bool released;
+
+	if (rai.done == 0) {
+		return;
+	}
+
+	released = (k_uptime_get() - rai.done) <=
+		   CONFIG_CLOUD_RAI_RELEASE_TIME;
+	rai.done = 0;
+
+	if (released) {
+		rai.ignored = 0;
+		return;
+	}
+
+	if (++rai.ignored >= CONFIG_CLOUD_RAI_IGNORED_MAX) {
+		LOG_WRN("RAI ignored by the network, no longer requested");
+		rai_set(false);
+		rai.disabled = true;
 	}
 }
+#endif
 
-static void config_get(void)
+static int qos_msg_send(int type, char *buf, size_t len,
+			uint16_t message_id, bool last)
 {
 	int err;
 
-	err = cloud_wrap_state_get();
+#if defined(CONFIG_CLOUD_RAI)
+	/* Only the last queued publication carries the indication. */
+	rai_set(last);
+#endif
+
+	err = wrap_send(type, buf, len, message_id);
 	if (err) {
-		LOG_ERR("cloud_wrap_state_get, err: %d", err);
-	} else {
-		LOG_DBG("Device configuration requested");
+		LOG_ERR("%s not sent, err: %d",
+			log_strdup(send_type2str(type)), err);
+		return err;
 	}
+
+	LOG_DBG("%s sent, message ID: %d",
+		log_strdup(send_type2str(type)), message_id);
+
+	return 0;
 }
 
-static void batch_data_send(struct data_module_event *evt)
+static void qos_msg_add(enum send_type type, char *buf, size_t len)
 {
 	int err;
 
-	err = cloud_wrap_batch_send(evt->data.buffer.buf, evt->data.buffer.len);
+	/* The Data module does not publish more buffers than it can keep
+	 * pending, so the list is not expected to fill up. A message that does
+	 * not fit is dropped without being acknowledged, it has not been
+	 * delivered.
+	 */
+	err = qos_list_add(&qos_list, type, buf, len);
 	if (err) {
-		LOG_ERR("cloud_wrap_batch_send, err: %d", err);
-	} else {
-		LOG_DBG("Batch sent");
+		LOG_ERR("QoS 1 list full, %s dropped",
+			log_strdup(send_type2str(type)));
+		return;
 	}
 
-	if (evt->data.buffer.len > 0) {
-		send_data_ack(evt->data.buffer.buf);
+	if (sub_state == SUB_STATE_CLOUD_CONNECTED) {
+		qos_list_process(&qos_list);
 	}
 }
 
-static void ui_data_send(struct data_module_event *evt)
+static void qos_msg_ack(uint16_t message_id)
 {
 	int err;
 
-	err = cloud_wrap_ui_send(evt->data.buffer.buf, evt->data.buffer.len);
+	err = qos_list_ack(&qos_list, message_id);
 	if (err) {
-		LOG_ERR("cloud_wrap_ui_send, err: %d", err);
+		return;
+	}
+
+	/* The last publication has been acknowledged, no more uplink data is
+	 * expected until the next sample cycle.
+	 */
+	if (qos_list_count(&qos_list) == 0) {
+#if defined(CONFIG_CLOUD_RAI)
+		if (rai.set) {
+			rai.done = k_uptime_get();
+		}
+
+		rai_set(false);
+#endif
+		SEND_EVENT(cloud, CLOUD_EVT_UPLINK_DONE);
+	}
+}
+#endif /* CONFIG_CLOUD_QOS_1 */
+
+static void buffer_send(enum send_type type, char *buf, size_t len)
+{
+#if defined(CONFIG_CLOUD_QOS_1)
+	qos_msg_add(type, buf, len);
+#else
+	int err;
+
+	err = wrap_send(type, buf, len, 0);
+	if (err) {
+		LOG_ERR("%s not sent, err: %d",
+			log_strdup(send_type2str(type)), err);
 	} else {
-		LOG_DBG("UI sent");
+		LOG_DBG("%s sent", log_strdup(send_type2str(type)));
 	}
 
-	if (evt->data.buffer.len > 0) {
-		send_data_ack(evt->data.buffer.buf);
+	send_data_ack(buf);
+#endif
+}
+
+#if defined(CONFIG_CLOUD_DEFER_DURING_GPS_SEARCH)
+/* Send messages that were held back during a GPS search. */
+static void deferred_list_flush(void)
+{
+	for (size_t i = 0; i < deferred_count; i++) {
+		buffer_send(deferred_list[i].type, deferred_list[i].buf,
+			    deferred_list[i].len);
+	}
+
+	deferred_count = 0;
+}
+#endif
+
+static void data_send(enum send_type type, struct data_module_event *evt)
+{
+	if (evt->data.buffer.len == 0) {
+		LOG_WRN("%s empty, not sent", log_strdup(send_type2str(type)));
+		return;
 	}
+
+#if defined(CONFIG_CLOUD_DEFER_DURING_GPS_SEARCH)
+	/* LTE activity blocks the GPS. UI data is sent right away, other
+	 * messages are held back until the GPS search has ended.
+	 */
+	if (gps_active && (type != SEND_TYPE_UI) &&
+	    (deferred_count < ARRAY_SIZE(deferred_list))) {
+		LOG_DBG("%s deferred until GPS search has ended",
+			log_strdup(send_type2str(type)));
+
+		deferred_list[deferred_count++] = (struct deferred_msg) {
+			.type = type,
+			.buf = evt->data.buffer.buf,
+			.len = evt->data.buffer.len
+		};
+
+		return;
+	}
+#endif
+
+	buffer_send(type, evt->data.buffer.buf, evt->data.buffer.len);
 }
 
 static void connect_cloud(void)
@@ -383,6 +651,14 @@ static void connect_cloud(void)
 	int err;
 	int backoff_sec = backoff_delay[connect_retries].delay;
 
+#if defined(CONFIG_CLOUD_DEFER_DURING_GPS_SEARCH)
+	if (gps_active) {
+		LOG_DBG("GPS search active, cloud connection postponed");
+		connect_pending = true;
+		return;
+	}
+#endif
+
 	LOG_DBG("Connecting to cloud");
 
 	if (connect_retries > CONFIG_CLOUD_CONNECT_RETRIES) {
@@ -433,6 +709,19 @@ static int setup(void)
 		return err;
 	}
 
+#if defined(CONFIG_CLOUD_QOS_1)
+	qos_list_init(&qos_list, qos_msgs, ARRAY_SIZE(qos_msgs),
+		      CONFIG_CLOUD_QOS_1_WINDOW, qos_msg_send, send_data_ack);
+#endif
+
+#if defined(CONFIG_AGPS_CACHE)
+	err = agps_cache_init();
+	if (err) {
+		LOG_ERR("agps_cache_init, error: %d", err);
+		return err;
+	}
+#endif
+
 	/* After a successful initializaton, tell the bootloader that the
 	 * current image is confirmed to be working.
 	 */
@@ -485,6 +774,10 @@ static void on_sub_state_cloud_connected(struct cloud_msg_data *msg)
 	if (IS_EVENT(msg, cloud, CLOUD_EVT_DISCONNECTED)) {
 		sub_state_set(SUB_STATE_CLOUD_DISCONNECTED);
 
+#if defined(CONFIG_AGPS_CACHE)
+		agps_cache_requests_abort();
+#endif
+
 		k_delayed_work_submit(&connect_check_work, K_NO_WAIT);
 
 		return;
@@ -494,8 +787,12 @@ static void on_sub_state_cloud_connected(struct cloud_msg_data *msg)
 	if (IS_EVENT(msg, gps, GPS_EVT_AGPS_NEEDED)) {
 		int err;
 
+#if defined(CONFIG_AGPS_CACHE)
+		err = agps_cache_request(msg->module.gps.data.agps_request);
+#else
 		err = gps_agps_request(msg->module.gps.data.agps_request,
 				       GPS_SOCKET_NOT_PROVIDED);
+#endif
 		if (err) {
 			LOG_WRN("Failed to request A-GPS data, error: %d", err);
 		}
@@ -504,12 +801,18 @@ static void on_sub_state_cloud_connected(struct cloud_msg_data *msg)
 	}
 #endif /* CONFIG_AGPS && CONFIG_AGPS_SRC_NRF_CLOUD */
 
+#if defined(CONFIG_CLOUD_QOS_1)
+	if (IS_EVENT(msg, cloud, CLOUD_EVT_PUBACK)) {
+		qos_msg_ack(msg->module.cloud.data.message_id);
+	}
+#endif
+
 	if (IS_EVENT(msg, data, DATA_EVT_DATA_SEND)) {
-		data_send(&msg->module.data);
+		data_send(SEND_TYPE_DATA, &msg->module.data);
 	}
 
 	if (IS_EVENT(msg, data, DATA_EVT_CONFIG_SEND)) {
-		config_send(&msg->module.data);
+		data_send(SEND_TYPE_CONFIG, &msg->module.data);
 	}
 
 	if (IS_EVENT(msg, data, DATA_EVT_CONFIG_GET)) {
@@ -517,11 +820,11 @@ static void on_sub_state_cloud_connected(struct cloud_msg_data *msg)
 	}
 
 	if (IS_EVENT(msg, data, DATA_EVT_DATA_SEND_BATCH)) {
-		batch_data_send(&msg->module.data);
+		data_send(SEND_TYPE_BATCH, &msg->module.data);
 	}
 
 	if (IS_EVENT(msg, data, DATA_EVT_UI_DATA_SEND)) {
-		ui_data_send(&msg->module.data);
+		data_send(SEND_TYPE_UI, &msg->module.data);
 	}
 }
 
@@ -533,6 +836,13 @@ static void on_sub_state_cloud_disconnected(struct cloud_msg_data *msg)
 
 		connect_retries = 0;
 		k_delayed_work_cancel(&connect_check_work);
+
+#if defined(CONFIG_CLOUD_QOS_1)
+		/* Retransmit messages that were not acknowledged before the
+		 * connection was lost.
+		 */
+		qos_list_process(&qos_list);
+#endif
 	}
 
 	if (IS_EVENT(msg, cloud, CLOUD_EVT_CONNECTION_TIMEOUT)) {
@@ -547,6 +857,57 @@ static void on_all_states(struct cloud_msg_data *msg)
 		SEND_EVENT(cloud, CLOUD_EVT_SHUTDOWN_READY);
 	}
 
+#if defined(CONFIG_CLOUD_QOS_1)
+	if ((IS_EVENT(msg, cloud, CLOUD_EVT_DISCONNECTED)) ||
+	    (IS_EVENT(msg, modem, MODEM_EVT_LTE_DISCONNECTED))) {
+		qos_list_reset(&qos_list);
+	}
+#endif
+
+#if defined(CONFIG_CLOUD_RAI)
+	if (IS_EVENT(msg, modem, MODEM_EVT_LTE_RRC_IDLE)) {
+		rai_release_check();
+	}
+
+	/* The indication must not be left set for the uplink of the next
+	 * connection or sample cycle if the last publication was not
+	 * acknowledged.
+	 */
+	if ((IS_EVENT(msg, cloud, CLOUD_EVT_DISCONNECTED)) ||
+	    (IS_EVENT(msg, modem, MODEM_EVT_LTE_DISCONNECTED)) ||
+	    (IS_EVENT(msg, app, APP_EVT_DATA_GET))) {
+		rai_set(false);
+	}
+#endif
+
+#if defined(CONFIG_CLOUD_DEFER_DURING_GPS_SEARCH)
+	if (IS_EVENT(msg, gps, GPS_EVT_ACTIVE)) {
+		gps_active = true;
+	}
+
+	if (IS_EVENT(msg, gps, GPS_EVT_INACTIVE)) {
+		gps_active = false;
+
+		if (sub_state == SUB_STATE_CLOUD_CONNECTED) {
+			deferred_list_flush();
+		}
+
+		if (connect_pending && (state == STATE_LTE_CONNECTED) &&
+		    (sub_state == SUB_STATE_CLOUD_DISCONNECTED)) {
+			connect_pending = false;
+			connect_cloud();
+		}
+	}
+
+	if (IS_EVENT(msg, cloud, CLOUD_EVT_CONNECTED) && !gps_active) {
+		deferred_list_flush();
+	}
+
+	if (IS_EVENT(msg, modem, MODEM_EVT_LTE_DISCONNECTED)) {
+		connect_pending = false;
+	}
+#endif
+
 	if (is_data_module_event(&msg->module.data.header)) {
 		switch (msg->module.data.type) {
 		case DATA_EVT_CONFIG_INIT:
@@ -8,6 +8,8 @@
 #include <event_manager.h>
 #include <settings/settings.h>
 #include <date_time.h>
+#include <math.h>
+#include <stdlib.h>
 
 #include "cloud/cloud_codec/cloud_codec.h"
 
@@ -28,6 +30,9 @@ LOG_MODULE_REGISTER(MODULE, CONFIG_DATA_MODULE_LOG_LEVEL);
 
 #define DEVICE_SETTINGS_KEY			"data_module"
 #define DEVICE_SETTINGS_CONFIG_KEY		"config"
+#define DEVICE_SETTINGS_CONFIG_VERSION_KEY	"config_version"
+#define DEVICE_SETTINGS_STATIC_HASH_KEY		"static_hash"
+#define DEVICE_SETTINGS_TRACKING_LATCH_KEY	"tracking_latch"
 
 /* Default device configuration values. */
 #define DEFAULT_ACTIVE_TIMEOUT_SECONDS		120
@@ -36,6 +41,18 @@ LOG_MODULE_REGISTER(MODULE, CONFIG_DATA_MODULE_LOG_LEVEL);
 #define DEFAULT_ACCELEROMETER_THRESHOLD		10
 #define DEFAULT_GPS_TIMEOUT_SECONDS		60
 #define DEFAULT_DEVICE_MODE			true
+#define DEFAULT_TRACKING_MODE			false
+#define DEFAULT_TRACKING_INTERVAL_SECONDS	5
+#define DEFAULT_TRACKING_DURATION_SECONDS	1800
+#define DEFAULT_TEMPERATURE_DELTA		0.2
+#define DEFAULT_HUMIDITY_DELTA			1.0
+#define DEFAULT_BATTERY_DELTA_MV		10
+#define DEFAULT_RSRP_DELTA_DB			3
+#define DEFAULT_MAX_SILENCE_SECONDS		3600
+
+/* Allowed range for the time between GPS fixes in Tracking mode. */
+#define TRACKING_INTERVAL_MIN	1
+#define TRACKING_INTERVAL_MAX	10
 
 /* Value that is used to limit the maximum allowed device configuration value
  * for the accelerometer threshold. 100 m/s2 ~ 10.2g.
@@ -70,15 +87,56 @@ static struct cloud_data_sensors sensors_buf[CONFIG_SENSOR_BUFFER_MAX];
 static struct cloud_data_ui ui_buf[CONFIG_UI_BUFFER_MAX];
 static struct cloud_data_accelerometer accel_buf[CONFIG_ACCEL_BUFFER_MAX];
 static struct cloud_data_battery bat_buf[CONFIG_BAT_BUFFER_MAX];
+static struct cloud_data_activity activity_buf[CONFIG_ACTIVITY_BUFFER_MAX];
 
 static struct cloud_data_modem_dynamic
 			modem_dyn_buf[CONFIG_MODEM_BUFFER_DYNAMIC_MAX];
 
+/* Serving cells recorded at every cell change. Only uploaded in batches. */
+static struct cloud_data_cell_trail
+			cell_trail_buf[CONFIG_CELL_TRAIL_BUFFER_MAX];
+
+/* Track buffer used in Tracking mode. GPS fixes are stored as differences to
+ * the previous fix in segments that are uploaded in batches when full.
+ */
+static struct cloud_data_track track_buf[CONFIG_TRACK_SEGMENT_COUNT];
+static struct cloud_data_track_point
+	track_points[CONFIG_TRACK_SEGMENT_COUNT][CONFIG_TRACK_SEGMENT_POINTS];
+
+/* Upper bound of an encoded track segment. Each point is encoded as up to
+ * three numbers of six characters with separators, the rest of the message
+ * takes less than 200 bytes.
+ */
+#define TRACK_SEGMENT_ENCODED_MAX (CONFIG_TRACK_SEGMENT_POINTS * 20 + 200)
+
+#if defined(CONFIG_AWS_IOT_MQTT_PAYLOAD_BUFFER_LEN)
+BUILD_ASSERT(TRACK_SEGMENT_ENCODED_MAX <=
+	     CONFIG_AWS_IOT_MQTT_PAYLOAD_BUFFER_LEN,
+	     "Track segments do not fit in the MQTT payload buffer");
+#endif
+
 /* Static modem data does not change between firmware versions and does not
  * have to be buffered.
  */
 static struct cloud_data_modem_static modem_stat;
 
+/* Hash of the static modem data in modem_stat, and of the static modem data
+ * that was last acknowledged by the cloud. Static modem data is only
+ * published when the two differ. With QoS 1 the acknowledgment is a PUBACK
+ * from the broker, and the acknowledged hash is persisted so that unchanged
+ * data is not published again after a reboot. With QoS 0 it only means that
+ * the data was written to the socket, so the data is published once per
+ * boot.
+ */
+static uint32_t modem_stat_hash;
+static uint32_t modem_stat_acked_hash;
+
+/* Encoded message that carries the static modem data until it is ACKed, and
+ * the hash of the data in it.
+ */
+static void *modem_stat_pending;
+static uint32_t modem_stat_pending_hash;
+
 /* Head of ringbuffers. */
 static int head_gps_buf;
 static int head_sensor_buf;
@@ -86,6 +144,17 @@ static int head_modem_dyn_buf;
 static int head_ui_buf;
 static int head_accel_buf;
 static int head_bat_buf;
+static int head_activity_buf;
+static int head_track_buf;
+static int head_cell_trail_buf;
+
+/* Set if the track segment at head_track_buf is being filled. */
+static bool track_open;
+
+/* Last point stored in the track segment being filled. */
+static int32_t track_last_lat;
+static int32_t track_last_lng;
+static int64_t track_last_ts;
 
 /* Default device configuration. */
 static struct cloud_data_cfg current_cfg = {
@@ -94,10 +163,112 @@ static struct cloud_data_cfg current_cfg = {
 	.active_wait_timeout = DEFAULT_ACTIVE_TIMEOUT_SECONDS,
 	.movement_resolution = DEFAULT_MOVEMENT_RESOLUTION_SECONDS,
 	.movement_timeout = DEFAULT_MOVEMENT_TIMEOUT_SECONDS,
-	.accelerometer_threshold = DEFAULT_ACCELEROMETER_THRESHOLD
+	.accelerometer_threshold = DEFAULT_ACCELEROMETER_THRESHOLD,
+	.tracking_mode = DEFAULT_TRACKING_MODE,
+	.tracking_interval = DEFAULT_TRACKING_INTERVAL_SECONDS,
+	.tracking_duration = DEFAULT_TRACKING_DURATION_SECONDS,
+	.temperature_delta = DEFAULT_TEMPERATURE_DELTA,
+	.humidity_delta = DEFAULT_HUMIDITY_DELTA,
+	.battery_delta = DEFAULT_BATTERY_DELTA_MV,
+	.rsrp_delta = DEFAULT_RSRP_DELTA_DB,
+	.max_silence = DEFAULT_MAX_SILENCE_SECONDS
 };
 
+/* Last stored sample of the data types that are filtered with a dead-band.
+ * A new sample is only stored if it differs from the last stored sample by
+ * at least the configured delta, or if the maximum silence time has passed.
+ */
+static struct {
+	bool valid;
+	int64_t time;
+	double temp;
+	double hum;
+} last_env;
+
+static struct {
+	bool valid;
+	int64_t time;
+	uint16_t bat;
+} last_bat;
+
+static struct {
+	bool valid;
+	int64_t time;
+	uint16_t area;
+	uint16_t cell;
+	uint16_t rsrp;
+	char ip[46];
+	char mccmnc[7];
+} last_modem_dyn;
+
+/* Number of samples per data type that were not stored because they were
+ * within the dead-band of the last stored sample.
+ */
+static struct {
+	uint32_t env;
+	uint32_t bat;
+	uint32_t modem_dyn;
+} suppressed;
+
+/* RSRP in dBm sampled once per sample cycle from dynamic modem data, and the
+ * most recent RSRP reported by the modem. Used to judge the link quality
+ * before batch uploads.
+ */
+static int rsrp_history[CONFIG_DATA_RSRP_HISTORY];
+static size_t rsrp_history_head;
+static size_t rsrp_history_count;
+static int rsrp_latest;
+
+/* Batch uploads are no longer deferred when a ringbuffer is filled to this
+ * percentage, so that deferred data is not overwritten.
+ */
+#define DEFER_BUFFER_FILL_MAX 75
+
+/* Dynamic modem data carries the RSRP index reported by the modem, 0 until
+ * the first report. The index is the RSRP in dBm plus this offset.
+ */
+#define RSRP_OFFSET_DBM 140
+
+/* Batch upload deferral. Batch data stays in the ringbuffers while the link
+ * is poor, until the link improves or the deadline has passed.
+ */
+static struct {
+	/* Set while batch uploads are deferred. */
+	bool active;
+	/* Set from the end of a deferral until the next sample cycle, batch
+	 * data sent in that time is counted in bytes.
+	 */
+	bool resumed;
+	/* Uptime when the current deferral started. */
+	int64_t start;
+	/* Totals since boot. */
+	uint32_t count;
+	uint32_t sent_improved;
+	uint32_t sent_deadline;
+	uint32_t sent_full;
+	uint32_t bytes;
+} defer;
+
+/* Version of the device configuration reported to cloud. Incremented when
+ * the configuration changes and persisted together with it, so that the cloud
+ * can detect missing reports. Reports of rejected fields only carry the
+ * current version.
+ */
+static uint32_t config_version;
+
 static struct k_delayed_work data_send_work;
+static struct k_delayed_work tracking_expiry_work;
+
+/* Tracking mode session that has expired. The desired configuration in the
+ * cloud keeps "trk" set after the session has expired, so the session is
+ * latched and not restarted until the cloud clears "trk" or requests a new
+ * session with a different "trks". Persisted so that the latch holds across
+ * reboots.
+ */
+static struct {
+	bool expired;
+	int start;
+} tracking_latch;
 
 /* List used to keep track of responses from other modules with data that is
  * requested to be sampled/published.
@@ -117,7 +288,12 @@ static int data_cnt;
 
 /* Data that has been encoded and shipped on, but has not yet been ACKed as sent
  */
-static void *pending_data[10];
+static void *pending_data[DATA_PENDING_MAX];
+
+/* Configuration fields that could not be reported because the pending list
+ * was full. Reported when pending data has been ACKed.
+ */
+static uint32_t config_fields_unsent;
 
 /* Data module message queue. */
 #define DATA_QUEUE_ENTRY_COUNT		10
@@ -133,6 +309,7 @@ static struct module_data self = {
 
 /* Forward declarations */
 static void data_send_work_fn(struct k_work *work);
+static void tracking_expiry_work_fn(struct k_work *work);
 static int config_settings_handler(const char *key, size_t len,
 				   settings_read_cb read_cb, void *cb_arg);
 
@@ -172,6 +349,7 @@ static bool event_handler(const struct event_header *eh)
 {
 	struct data_msg_data msg = {0};
 	bool enqueue_msg = false;
+	uint32_t start = k_cycle_get_32();
 
 	if (is_modem_module_event(eh)) {
 		struct modem_module_event *event = cast_modem_module_event(eh);
@@ -239,6 +417,8 @@ static bool event_handler(const struct event_header *eh)
 		}
 	}
 
+	module_handler_stats_update(&self, start);
+
 	return false;
 }
 
@@ -253,6 +433,41 @@ static int config_settings_handler(const char *key, size_t len,
 			LOG_ERR("Failed to load configuration, error: %d", err);
 			return err;
 		}
+
+		/* Tracking mode is not resumed from flash after a reboot.
+		 * It is restarted for the remaining time of the session, if
+		 * any, when the configuration is received from cloud.
+		 */
+		current_cfg.tracking_mode = false;
+	}
+
+	if (strcmp(key, DEVICE_SETTINGS_CONFIG_VERSION_KEY) == 0) {
+		err = read_cb(cb_arg, &config_version, sizeof(config_version));
+		if (err < 0) {
+			LOG_ERR("Failed to load config version, error: %d",
+				err);
+			return err;
+		}
+	}
+
+	if (strcmp(key, DEVICE_SETTINGS_TRACKING_LATCH_KEY) == 0) {
+		err = read_cb(cb_arg, &tracking_latch, sizeof(tracking_latch));
+		if (err < 0) {
+			LOG_ERR("Failed to load tracking latch, error: %d",
+				err);
+			return err;
+		}
+	}
+
+	if (IS_ENABLED(CONFIG_CLOUD_QOS_1) &&
+	    (strcmp(key, DEVICE_SETTINGS_STATIC_HASH_KEY) == 0)) {
+		err = read_cb(cb_arg, &modem_stat_acked_hash,
+			      sizeof(modem_stat_acked_hash));
+		if (err < 0) {
+			LOG_ERR("Failed to load static data hash, error: %d",
+				err);
+			return err;
+		}
 	}
 
 	LOG_DBG("Device configuration loaded from flash");
@@ -301,6 +516,19 @@ static bool pending_data_add(void *ptr)
 	return false;
 }
 
+static size_t pending_data_free_count(void)
+{
+	size_t count = 0;
+
+	for (size_t i = 0; i < ARRAY_SIZE(pending_data); i++) {
+		if (pending_data[i] == NULL) {
+			count++;
+		}
+	}
+
+	return count;
+}
+
 static bool pending_data_ack(void *ptr)
 {
 	for (size_t i = 0; i < ARRAY_SIZE(pending_data); i++) {
@@ -332,11 +560,45 @@ static int save_config(const void *buf, size_t buf_len)
 		return err;
 	}
 
+	err = settings_save_one(DEVICE_SETTINGS_KEY "/"
+				DEVICE_SETTINGS_CONFIG_VERSION_KEY,
+				&config_version, sizeof(config_version));
+	if (err) {
+		LOG_WRN("settings_save_one, error: %d", err);
+		return err;
+	}
+
 	LOG_DBG("Device configuration stored to flash");
 
 	return 0;
 }
 
+/* Store the hash of static modem data that has been acknowledged by the
+ * cloud. It is only persisted if the acknowledgment is a PUBACK.
+ */
+static void static_hash_save(uint32_t hash)
+{
+	int err;
+
+	if (hash == modem_stat_acked_hash) {
+		return;
+	}
+
+	modem_stat_acked_hash = hash;
+
+	if (!IS_ENABLED(CONFIG_CLOUD_QOS_1)) {
+		return;
+	}
+
+	err = settings_save_one(DEVICE_SETTINGS_KEY "/"
+				DEVICE_SETTINGS_STATIC_HASH_KEY,
+				&modem_stat_acked_hash,
+				sizeof(modem_stat_acked_hash));
+	if (err) {
+		LOG_WRN("Static data hash not stored, error: %d", err);
+	}
+}
+
 static int setup(void)
 {
 	int err;
@@ -368,14 +630,234 @@ static void config_distribute(enum data_module_event_type type)
 	EVENT_SUBMIT(data_module_event);
 }
 
+/* Discard cell trail entries that are older than the retention time. */
+static void cell_trail_expire(void)
+{
+	int64_t limit = k_uptime_get() -
+			(int64_t)CONFIG_CELL_TRAIL_RETENTION * MSEC_PER_SEC;
+
+	for (size_t i = 0; i < ARRAY_SIZE(cell_trail_buf); i++) {
+		if (cell_trail_buf[i].ts < limit) {
+			cell_trail_buf[i].queued = false;
+		}
+	}
+}
+
+static bool silence_expired(int64_t last_time)
+{
+	return k_uptime_get() - last_time >=
+	       (int64_t)current_cfg.max_silence * MSEC_PER_SEC;
+}
+
+/* Returns true if the environmental sample is to be stored. */
+static bool env_delta_check(double temp, double hum)
+{
+	if (last_env.valid && !silence_expired(last_env.time) &&
+	    (fabs(temp - last_env.temp) < current_cfg.temperature_delta) &&
+	    (fabs(hum - last_env.hum) < current_cfg.humidity_delta)) {
+		suppressed.env++;
+		LOG_DBG("Environmental sample suppressed, total: %d",
+			suppressed.env);
+		return false;
+	}
+
+	last_env.valid = true;
+	last_env.time = k_uptime_get();
+	last_env.temp = temp;
+	last_env.hum = hum;
+
+	return true;
+}
+
+/* Returns true if the battery sample is to be stored. */
+static bool bat_delta_check(uint16_t bat)
+{
+	if (last_bat.valid && !silence_expired(last_bat.time) &&
+	    (abs(bat - last_bat.bat) < current_cfg.battery_delta)) {
+		suppressed.bat++;
+		LOG_DBG("Battery sample suppressed, total: %d", suppressed.bat);
+		return false;
+	}
+
+	last_bat.valid = true;
+	last_bat.time = k_uptime_get();
+	last_bat.bat = bat;
+
+	return true;
+}
+
+/* Returns true if the dynamic modem data is to be stored. A change of
+ * serving cell or network is always stored.
+ */
+static bool modem_dyn_delta_check(const struct cloud_data_modem_dynamic *data)
+{
+	const char *ip = data->ip != NULL ? data->ip : "";
+	const char *mccmnc = data->mccmnc != NULL ? data->mccmnc : "";
+
+	if (last_modem_dyn.valid && !silence_expired(last_modem_dyn.time) &&
+	    (data->area == last_modem_dyn.area) &&
+	    (data->cell == last_modem_dyn.cell) &&
+	    (strcmp(ip, last_modem_dyn.ip) == 0) &&
+	    (strcmp(mccmnc, last_modem_dyn.mccmnc) == 0) &&
+	    (abs(data->rsrp - last_modem_dyn.rsrp) < current_cfg.rsrp_delta)) {
+		suppressed.modem_dyn++;
+		LOG_DBG("Dynamic modem data suppressed, total: %d",
+			suppressed.modem_dyn);
+		return false;
+	}
+
+	last_modem_dyn.valid = true;
+	last_modem_dyn.time = k_uptime_get();
+	last_modem_dyn.area = data->area;
+	last_modem_dyn.cell = data->cell;
+	last_modem_dyn.rsrp = data->rsrp;
+	strncpy(last_modem_dyn.ip, ip, sizeof(last_modem_dyn.ip) - 1);
+	strncpy(last_modem_dyn.mccmnc, mccmnc,
+		sizeof(last_modem_dyn.mccmnc) - 1);
+
+	return true;
+}
+
+static void rsrp_history_add(int rsrp)
+{
+	rsrp_history[rsrp_history_head] = rsrp;
+	rsrp_history_head = (rsrp_history_head + 1) % ARRAY_SIZE(rsrp_history);
+	rsrp_history_count = MIN(rsrp_history_count + 1,
+				 ARRAY_SIZE(rsrp_history));
+}
+
+/* The link is poor if both the average of the RSRP history and the most
+ * recent RSRP are below the threshold, so that a single poor sample does not
+ * defer uploads and a good one ends the deferral right away. The link is
+ * assumed to be good if no RSRP has been sampled.
+ */
+static bool rsrp_link_good(int *average)
+{
+	int sum = 0;
+
+	if (rsrp_history_count == 0) {
+		return true;
+	}
+
+	for (size_t i = 0; i < rsrp_history_count; i++) {
+		sum += rsrp_history[i];
+	}
+
+	*average = sum / (int)rsrp_history_count;
+
+	return (*average >= CONFIG_DATA_DEFER_RSRP_THRESHOLD) ||
+	       (rsrp_latest >= CONFIG_DATA_DEFER_RSRP_THRESHOLD);
+}
+
+/* Number of queued entries in a ringbuffer, given the queued flag of its
+ * first entry and the size of an entry.
+ */
+static size_t queued_count(const bool *queued, size_t entry_size,
+			   size_t entries)
+{
+	size_t count = 0;
+
+	for (size_t i = 0; i < entries; i++) {
+		count += *(const bool *)((const uint8_t *)queued +
+					 i * entry_size);
+	}
+
+	return count;
+}
+
+#define BUFFER_FILLED(_buf)						\
+	(queued_count(&(_buf)[0].queued, sizeof((_buf)[0]),		\
+		      ARRAY_SIZE(_buf)) * 100 >=			\
+	 ARRAY_SIZE(_buf) * DEFER_BUFFER_FILL_MAX)
+
+/* Returns true if any ringbuffer of batch data is about to overwrite queued
+ * entries.
+ */
+static bool batch_buffers_filled(void)
+{
+	return BUFFER_FILLED(gps_buf) || BUFFER_FILLED(sensors_buf) ||
+	       BUFFER_FILLED(ui_buf) || BUFFER_FILLED(accel_buf) ||
+	       BUFFER_FILLED(bat_buf) || BUFFER_FILLED(activity_buf) ||
+	       BUFFER_FILLED(modem_dyn_buf) || BUFFER_FILLED(cell_trail_buf) ||
+	       BUFFER_FILLED(track_buf);
+}
+
+/* Returns true if batch uploads are to be deferred because of a poor link. */
+static bool batch_upload_deferred(void)
+{
+	int rsrp = 0;
+	bool link_good;
+	bool filled;
+	int64_t deferred_time;
+
+	if (!IS_ENABLED(CONFIG_DATA_DEFER_BATCH)) {
+		return false;
+	}
+
+	link_good = rsrp_link_good(&rsrp);
+	filled = batch_buffers_filled();
+	deferred_time = k_uptime_get() - defer.start;
+
+	if (!defer.active) {
+		if (link_good || filled) {
+			return false;
+		}
+
+		defer.active = true;
+		defer.resumed = false;
+		defer.start = k_uptime_get();
+		defer.count++;
+
+		LOG_INF("Poor link, RSRP: %d dBm, batch uploads deferred",
+			rsrp);
+
+		return true;
+	}
+
+	if (!link_good && !filled &&
+	    (deferred_time < CONFIG_DATA_DEFER_DEADLINE * MSEC_PER_SEC)) {
+		return true;
+	}
+
+	if (link_good) {
+		defer.sent_improved++;
+	} else if (filled) {
+		defer.sent_full++;
+	} else {
+		defer.sent_deadline++;
+	}
+
+	defer.active = false;
+	defer.resumed = true;
+
+	LOG_INF("Deferred batch uploads sent after %d s, %s, RSRP: %d dBm",
+		(int)(deferred_time / MSEC_PER_SEC),
+		link_good ? "link improved" :
+		filled ? "buffers filled" : "deadline passed", rsrp);
+	LOG_INF("Deferrals: %u, sent on improvement: %u, buffers filled: %u, "
+		"deadline: %u", defer.count, defer.sent_improved,
+		defer.sent_full, defer.sent_deadline);
+
+	return false;
+}
+
+static void batch_upload_sent(size_t len)
+{
+	if (defer.resumed) {
+		defer.bytes += len;
+		LOG_DBG("Deferred batch data sent: %d bytes in total",
+			defer.bytes);
+	}
+}
+
 /* This function allocates buffer on the heap, which needs to be freed afte use.
  */
 static void data_send(void)
 {
 	int err;
 	struct data_module_event *data_module_event_new;
-	struct data_module_event *data_module_event_batch;
 	struct cloud_codec_data codec;
+	bool modem_stat_queued = modem_stat.queued;
 
 	if (!date_time_is_valid()) {
 		/* Date time library does not have valid time to
@@ -385,6 +867,11 @@ static void data_send(void)
 		return;
 	}
 
+	if (pending_data_free_count() == 0) {
+		LOG_WRN("Pending list full, data kept in ringbuffers");
+		return;
+	}
+
 	err = cloud_codec_encode_data(
 		&codec,
 		&gps_buf[head_gps_buf],
@@ -393,7 +880,8 @@ static void data_send(void)
 		&modem_dyn_buf[head_modem_dyn_buf],
 		&ui_buf[head_ui_buf],
 		&accel_buf[head_accel_buf],
-		&bat_buf[head_bat_buf]);
+		&bat_buf[head_bat_buf],
+		&activity_buf[head_activity_buf]);
 	if (err == -ENODATA) {
 		/* This error might occurs when data has not been obtained prior
 		 * to data encoding.
@@ -416,11 +904,34 @@ static void data_send(void)
 	data_module_event_new->data.buffer.buf = codec.buf;
 	data_module_event_new->data.buffer.len = codec.len;
 
+	if (modem_stat_queued && !modem_stat.queued) {
+		modem_stat_pending = codec.buf;
+		modem_stat_pending_hash = modem_stat_hash;
+	}
+
 	pending_data_add(codec.buf);
 	EVENT_SUBMIT(data_module_event_new);
+}
+
+/* Non-urgent data is uploaded in batches that are deferred while the link is
+ * poor.
+ */
+static void batch_send(void)
+{
+	int err;
+	struct data_module_event *data_module_event_batch;
+	struct cloud_codec_data codec;
 
-	codec.buf = NULL;
-	codec.len = 0;
+	if (!date_time_is_valid() || batch_upload_deferred()) {
+		return;
+	}
+
+	if (pending_data_free_count() == 0) {
+		LOG_WRN("Pending list full, batch data kept in ringbuffers");
+		return;
+	}
+
+	cell_trail_expire();
 
 	err = cloud_codec_encode_batch_data(&codec,
 					gps_buf,
@@ -429,12 +940,16 @@ static void data_send(void)
 					ui_buf,
 					accel_buf,
 					bat_buf,
+					cell_trail_buf,
+					activity_buf,
 					ARRAY_SIZE(gps_buf),
 					ARRAY_SIZE(sensors_buf),
 					ARRAY_SIZE(modem_dyn_buf),
 					ARRAY_SIZE(ui_buf),
 					ARRAY_SIZE(accel_buf),
-					ARRAY_SIZE(bat_buf));
+					ARRAY_SIZE(bat_buf),
+					ARRAY_SIZE(cell_trail_buf),
+					ARRAY_SIZE(activity_buf));
 	if (err == -ENODATA) {
 		LOG_WRN("No batch data to encode, ringbuffers empty");
 		return;
@@ -449,22 +964,197 @@ static void data_send(void)
 	data_module_event_batch->data.buffer.buf = codec.buf;
 	data_module_event_batch->data.buffer.len = codec.len;
 
+	batch_upload_sent(codec.len);
 	pending_data_add(codec.buf);
 	EVENT_SUBMIT(data_module_event_batch);
 }
 
+/* Close the track segment being filled. Closed segments are queued for
+ * upload.
+ */
+static void track_segment_close(void)
+{
+	if (!track_open) {
+		return;
+	}
+
+	track_buf[head_track_buf].queued = true;
+	track_open = false;
+
+	head_track_buf++;
+
+	if (head_track_buf == ARRAY_SIZE(track_buf)) {
+		head_track_buf = 0;
+	}
+}
+
+static void track_point_add(struct gps_module_data *fix)
+{
+	struct cloud_data_track *segment = &track_buf[head_track_buf];
+	int32_t lat = (int32_t)lround(fix->latitude * 1000000.0);
+	int32_t lng = (int32_t)lround(fix->longitude * 1000000.0);
+
+	if (track_open) {
+		int32_t dlat = lat - track_last_lat;
+		int32_t dlng = lng - track_last_lng;
+		int64_t dt = (fix->timestamp - track_last_ts) / 100;
+
+		/* Start a new segment if the segment is full or if the
+		 * difference to the previous point does not fit in a point.
+		 */
+		if ((segment->count < CONFIG_TRACK_SEGMENT_POINTS) &&
+		    (dlat >= INT16_MIN) && (dlat <= INT16_MAX) &&
+		    (dlng >= INT16_MIN) && (dlng <= INT16_MAX) &&
+		    (dt >= 0) && (dt <= UINT16_MAX)) {
+			segment->points[segment->count].dt = dt;
+			segment->points[segment->count].dlat = dlat;
+			segment->points[segment->count].dlng = dlng;
+			segment->count++;
+			goto exit;
+		}
+
+		track_segment_close();
+		segment = &track_buf[head_track_buf];
+	}
+
+	if (segment->queued) {
+		LOG_WRN("Track buffer full, oldest segment overwritten");
+	}
+
+	segment->ts = fix->timestamp;
+	segment->lat = lat;
+	segment->lng = lng;
+	segment->points = track_points[head_track_buf];
+	segment->count = 0;
+	segment->queued = false;
+
+	track_open = true;
+
+exit:
+	track_last_lat = lat;
+	track_last_lng = lng;
+	track_last_ts = fix->timestamp;
+}
+
+/* Upload closed track segments, oldest first. A couple of entries in the
+ * pending list are left for regular data. Remaining segments are sent when
+ * pending data has been ACKed.
+ */
+static void track_send(void)
+{
+	int err;
+	struct cloud_codec_data codec;
+	struct data_module_event *evt;
+
+	if (!date_time_is_valid() || batch_upload_deferred()) {
+		return;
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(track_buf); i++) {
+		size_t idx = (head_track_buf + i) % ARRAY_SIZE(track_buf);
+
+		if (!track_buf[idx].queued) {
+			continue;
+		}
+
+		if (pending_data_free_count() <= 2) {
+			LOG_DBG("Pending list full, track upload postponed");
+			return;
+		}
+
+		err = cloud_codec_encode_track(&codec, &track_buf[idx]);
+		if (err) {
+			LOG_ERR("Error encoding track, error: %d", err);
+			SEND_ERROR(data, DATA_EVT_ERROR, err);
+			return;
+		}
+
+		evt = new_data_module_event();
+		evt->type = DATA_EVT_DATA_SEND_BATCH;
+		evt->data.buffer.buf = codec.buf;
+		evt->data.buffer.len = codec.len;
+
+		batch_upload_sent(codec.len);
+		pending_data_add(codec.buf);
+		EVENT_SUBMIT(evt);
+	}
+}
+
+static void tracking_expiry_work_fn(struct k_work *work)
+{
+	SEND_EVENT(data, DATA_EVT_TRACKING_EXPIRED);
+}
+
+static void tracking_latch_set(bool expired)
+{
+	int err;
+
+	if ((tracking_latch.expired == expired) &&
+	    (tracking_latch.start == current_cfg.tracking_start)) {
+		return;
+	}
+
+	tracking_latch.expired = expired;
+	tracking_latch.start = current_cfg.tracking_start;
+
+	err = settings_save_one(DEVICE_SETTINGS_KEY "/"
+				DEVICE_SETTINGS_TRACKING_LATCH_KEY,
+				&tracking_latch, sizeof(tracking_latch));
+	if (err) {
+		LOG_WRN("Tracking latch not stored, error: %d", err);
+	}
+}
+
+/* Returns the remaining time of the requested Tracking mode session in
+ * seconds, 0 if it has expired. Without a session start, or before the date
+ * time is known, the session lasts for the full duration from now.
+ */
+static int tracking_remaining_get(void)
+{
+	int64_t now;
+	int64_t end;
+
+	if (tracking_latch.expired &&
+	    (tracking_latch.start == current_cfg.tracking_start)) {
+		return 0;
+	}
+
+	if ((current_cfg.tracking_start == 0) || date_time_now(&now)) {
+		return current_cfg.tracking_duration;
+	}
+
+	end = (int64_t)current_cfg.tracking_start +
+	      current_cfg.tracking_duration;
+
+	return CLAMP(end - now / MSEC_PER_SEC, 0,
+		     current_cfg.tracking_duration);
+}
+
 static void config_get(void)
 {
 	SEND_EVENT(data, DATA_EVT_CONFIG_GET);
 }
 
-static void config_send(void)
+/* Report the given configuration fields to cloud. Fields are set in the
+ * bitmask if they have been changed or if a new value has been rejected.
+ */
+static void config_send(uint32_t fields)
 {
 	int err;
 	struct cloud_codec_data codec;
 	struct data_module_event *evt;
 
-	err = cloud_codec_encode_config(&codec, &current_cfg);
+	if (pending_data_free_count() == 0) {
+		LOG_WRN("Pending list full, configuration report postponed");
+		config_fields_unsent |= fields;
+		return;
+	}
+
+	fields |= config_fields_unsent;
+	config_fields_unsent = 0;
+
+	err = cloud_codec_encode_config(&codec, &current_cfg, fields,
+					config_version);
 	if (err) {
 		LOG_ERR("Error encoding configuration, error: %d", err);
 		SEND_ERROR(data, DATA_EVT_ERROR, err);
@@ -495,6 +1185,14 @@ static void data_ui_send(void)
 		return;
 	}
 
+	/* The button press stays queued in the ringbuffer and is included in
+	 * the next batch upload.
+	 */
+	if (pending_data_free_count() == 0) {
+		LOG_WRN("Pending list full, UI data kept in ringbuffer");
+		return;
+	}
+
 	err = cloud_codec_encode_ui_data(&codec, &ui_buf[head_ui_buf]);
 	if (err) {
 		LOG_ERR("Encoding button press, error: %d", err);
@@ -569,7 +1267,10 @@ static void on_cloud_state_disconnected(struct data_msg_data *msg)
 static void on_cloud_state_connected(struct data_msg_data *msg)
 {
 	if (IS_EVENT(msg, data, DATA_EVT_DATA_READY)) {
+		defer.resumed = false;
 		data_send();
+		batch_send();
+		track_send();
 		return;
 	}
 
@@ -592,7 +1293,9 @@ static void on_cloud_state_connected(struct data_msg_data *msg)
 	if (IS_EVENT(msg, cloud, CLOUD_EVT_CONFIG_RECEIVED)) {
 
 		int err;
-		bool config_change = false;
+		int remaining;
+		uint32_t changed = 0;
+		uint32_t rejected = 0;
 		struct cloud_data_cfg new = {
 		.active_mode =
 			msg->module.cloud.data.config.active_mode,
@@ -606,6 +1309,24 @@ static void on_cloud_state_connected(struct data_msg_data *msg)
 			msg->module.cloud.data.config.gps_timeout,
 		.accelerometer_threshold =
 			msg->module.cloud.data.config.accelerometer_threshold,
+		.tracking_mode =
+			msg->module.cloud.data.config.tracking_mode,
+		.tracking_interval =
+			msg->module.cloud.data.config.tracking_interval,
+		.tracking_duration =
+			msg->module.cloud.data.config.tracking_duration,
+		.temperature_delta =
+			msg->module.cloud.data.config.temperature_delta,
+		.humidity_delta =
+			msg->module.cloud.data.config.humidity_delta,
+		.battery_delta =
+			msg->module.cloud.data.config.battery_delta,
+		.rsrp_delta =
+			msg->module.cloud.data.config.rsrp_delta,
+		.max_silence =
+			msg->module.cloud.data.config.max_silence,
+		.tracking_start =
+			msg->module.cloud.data.config.tracking_start,
 		};
 
 		/* Guards making sure that only valid configuration values are
@@ -619,7 +1340,7 @@ static void on_cloud_state_connected(struct data_msg_data *msg)
 			} else {
 				LOG_WRN("New Device mode: Passive");
 			}
-			config_change = true;
+			changed |= CLOUD_DATA_CFG_ACTIVE_MODE;
 		}
 
 		if (new.gps_timeout > 0) {
@@ -627,11 +1348,15 @@ static void on_cloud_state_connected(struct data_msg_data *msg)
 				current_cfg.gps_timeout = new.gps_timeout;
 				LOG_WRN("New GPS timeout: %d",
 					current_cfg.gps_timeout);
-				config_change = true;
+				changed |= CLOUD_DATA_CFG_GPS_TIMEOUT;
 			}
 		} else {
 			LOG_ERR("New GPS timeout out of range: %d",
 				new.gps_timeout);
+
+			if (current_cfg.gps_timeout != new.gps_timeout) {
+				rejected |= CLOUD_DATA_CFG_GPS_TIMEOUT;
+			}
 		}
 
 		/* Only apply a new Active wait timeout or movement resolution
@@ -647,11 +1372,17 @@ static void on_cloud_state_connected(struct data_msg_data *msg)
 					new.active_wait_timeout;
 				LOG_WRN("New Active wait timeout: %d",
 					current_cfg.active_wait_timeout);
-				config_change = true;
+				changed |=
+					CLOUD_DATA_CFG_ACTIVE_WAIT_TIMEOUT;
 			}
 		} else {
 			LOG_ERR("New Active timeout out of range: %d",
 				new.active_wait_timeout);
+
+			if (current_cfg.active_wait_timeout !=
+			    new.active_wait_timeout) {
+				rejected |= CLOUD_DATA_CFG_ACTIVE_WAIT_TIMEOUT;
+			}
 		}
 
 		if ((new.movement_resolution > current_cfg.gps_timeout + 10) &&
@@ -662,11 +1393,17 @@ static void on_cloud_state_connected(struct data_msg_data *msg)
 					new.movement_resolution;
 				LOG_WRN("New Movement resolution: %d",
 					current_cfg.movement_resolution);
-				config_change = true;
+				changed |=
+					CLOUD_DATA_CFG_MOVEMENT_RESOLUTION;
 			}
 		} else {
 			LOG_ERR("New Movement resolution out of range: %d",
 				new.movement_resolution);
+
+			if (current_cfg.movement_resolution !=
+			    new.movement_resolution) {
+				rejected |= CLOUD_DATA_CFG_MOVEMENT_RESOLUTION;
+			}
 		}
 
 		if (new.movement_timeout > 0) {
@@ -676,11 +1413,16 @@ static void on_cloud_state_connected(struct data_msg_data *msg)
 					new.movement_timeout;
 				LOG_WRN("New Movement timeout: %d",
 					current_cfg.movement_timeout);
-				config_change = true;
+				changed |= CLOUD_DATA_CFG_MOVEMENT_TIMEOUT;
 			}
 		} else {
 			LOG_ERR("New Movement timeout out of range: %d",
 				new.movement_timeout);
+
+			if (current_cfg.movement_timeout !=
+			    new.movement_timeout) {
+				rejected |= CLOUD_DATA_CFG_MOVEMENT_TIMEOUT;
+			}
 		}
 
 		if ((new.accelerometer_threshold < ACCELEROMETER_S_M2_MAX) &&
@@ -691,18 +1433,185 @@ static void on_cloud_state_connected(struct data_msg_data *msg)
 					new.accelerometer_threshold;
 				LOG_WRN("New Accelerometer threshold: %f",
 					current_cfg.accelerometer_threshold);
-				config_change = true;
+				changed |=
+					CLOUD_DATA_CFG_ACCELEROMETER_THRESHOLD;
 			}
 		} else {
 			LOG_ERR("New Accelerometer threshold out of range: %f",
 				new.accelerometer_threshold);
+
+			if (current_cfg.accelerometer_threshold !=
+			    new.accelerometer_threshold) {
+				rejected |=
+					CLOUD_DATA_CFG_ACCELEROMETER_THRESHOLD;
+			}
 		}
 
-		err = save_config(&current_cfg,
-					sizeof(current_cfg));
-		if (err) {
-			LOG_WRN("Configuration not stored, error: %d",
-				err);
+		if ((new.tracking_interval >= TRACKING_INTERVAL_MIN) &&
+		    (new.tracking_interval <= TRACKING_INTERVAL_MAX)) {
+			if (current_cfg.tracking_interval !=
+			    new.tracking_interval) {
+				current_cfg.tracking_interval =
+					new.tracking_interval;
+				LOG_WRN("New Tracking interval: %d",
+					current_cfg.tracking_interval);
+				changed |= CLOUD_DATA_CFG_TRACKING_INTERVAL;
+			}
+		} else {
+			LOG_ERR("New Tracking interval out of range: %d",
+				new.tracking_interval);
+
+			if (current_cfg.tracking_interval !=
+			    new.tracking_interval) {
+				rejected |= CLOUD_DATA_CFG_TRACKING_INTERVAL;
+			}
+		}
+
+		if (new.tracking_duration > 0) {
+			if (current_cfg.tracking_duration !=
+			    new.tracking_duration) {
+				current_cfg.tracking_duration =
+					new.tracking_duration;
+				LOG_WRN("New Tracking duration: %d",
+					current_cfg.tracking_duration);
+				changed |= CLOUD_DATA_CFG_TRACKING_DURATION;
+			}
+		} else {
+			LOG_ERR("New Tracking duration out of range: %d",
+				new.tracking_duration);
+
+			if (current_cfg.tracking_duration !=
+			    new.tracking_duration) {
+				rejected |= CLOUD_DATA_CFG_TRACKING_DURATION;
+			}
+		}
+
+		/* A delta of 0 stores every sample. */
+		if (new.temperature_delta >= 0) {
+			if (current_cfg.temperature_delta !=
+			    new.temperature_delta) {
+				current_cfg.temperature_delta =
+					new.temperature_delta;
+				LOG_WRN("New Temperature delta: %f",
+					current_cfg.temperature_delta);
+				changed |= CLOUD_DATA_CFG_TEMPERATURE_DELTA;
+			}
+		} else {
+			LOG_ERR("New Temperature delta out of range: %f",
+				new.temperature_delta);
+			rejected |= CLOUD_DATA_CFG_TEMPERATURE_DELTA;
+		}
+
+		if (new.humidity_delta >= 0) {
+			if (current_cfg.humidity_delta != new.humidity_delta) {
+				current_cfg.humidity_delta =
+					new.humidity_delta;
+				LOG_WRN("New Humidity delta: %f",
+					current_cfg.humidity_delta);
+				changed |= CLOUD_DATA_CFG_HUMIDITY_DELTA;
+			}
+		} else {
+			LOG_ERR("New Humidity delta out of range: %f",
+				new.humidity_delta);
+			rejected |= CLOUD_DATA_CFG_HUMIDITY_DELTA;
+		}
+
+		if (new.battery_delta >= 0) {
+			if (current_cfg.battery_delta != new.battery_delta) {
+				current_cfg.battery_delta = new.battery_delta;
+				LOG_WRN("New Battery delta: %d",
+					current_cfg.battery_delta);
+				changed |= CLOUD_DATA_CFG_BATTERY_DELTA;
+			}
+		} else {
+			LOG_ERR("New Battery delta out of range: %d",
+				new.battery_delta);
+			rejected |= CLOUD_DATA_CFG_BATTERY_DELTA;
+		}
+
+		if (new.rsrp_delta >= 0) {
+			if (current_cfg.rsrp_delta != new.rsrp_delta) {
+				current_cfg.rsrp_delta = new.rsrp_delta;
+				LOG_WRN("New RSRP delta: %d",
+					current_cfg.rsrp_delta);
+				changed |= CLOUD_DATA_CFG_RSRP_DELTA;
+			}
+		} else {
+			LOG_ERR("New RSRP delta out of range: %d",
+				new.rsrp_delta);
+			rejected |= CLOUD_DATA_CFG_RSRP_DELTA;
+		}
+
+		if (new.max_silence > 0) {
+			if (current_cfg.max_silence != new.max_silence) {
+				current_cfg.max_silence = new.max_silence;
+				LOG_WRN("New Maximum silence: %d",
+					current_cfg.max_silence);
+				changed |= CLOUD_DATA_CFG_MAX_SILENCE;
+			}
+		} else {
+			LOG_ERR("New Maximum silence out of range: %d",
+				new.max_silence);
+
+			if (current_cfg.max_silence != new.max_silence) {
+				rejected |= CLOUD_DATA_CFG_MAX_SILENCE;
+			}
+		}
+
+		if (current_cfg.tracking_start != new.tracking_start) {
+			current_cfg.tracking_start = new.tracking_start;
+			LOG_WRN("New Tracking start: %d",
+				current_cfg.tracking_start);
+			changed |= CLOUD_DATA_CFG_TRACKING_START;
+		}
+
+		/* Tracking mode is disabled automatically when the tracking
+		 * duration has passed. An expired session stays latched until
+		 * the cloud clears "trk" or requests a new session.
+		 */
+		if (!new.tracking_mode) {
+			tracking_latch_set(false);
+		}
+
+		remaining = new.tracking_mode ? tracking_remaining_get() : 0;
+
+		if (new.tracking_mode && (remaining == 0)) {
+			LOG_WRN("Tracking session has expired, not restarted");
+			tracking_latch_set(true);
+		}
+
+		if (current_cfg.tracking_mode != (remaining > 0)) {
+			current_cfg.tracking_mode = remaining > 0;
+
+			if (current_cfg.tracking_mode) {
+				LOG_WRN("Tracking mode enabled for %d seconds",
+					remaining);
+				k_delayed_work_submit(&tracking_expiry_work,
+						      K_SECONDS(remaining));
+			} else {
+				LOG_WRN("Tracking mode disabled");
+				k_delayed_work_cancel(&tracking_expiry_work);
+				track_segment_close();
+				track_send();
+			}
+			changed |= CLOUD_DATA_CFG_TRACKING_MODE;
+		} else if (current_cfg.tracking_mode &&
+			   (changed & (CLOUD_DATA_CFG_TRACKING_START |
+				       CLOUD_DATA_CFG_TRACKING_DURATION))) {
+			LOG_WRN("Tracking session updated, %d seconds left",
+				remaining);
+			k_delayed_work_submit(&tracking_expiry_work,
+					      K_SECONDS(remaining));
+		}
+
+		if (changed) {
+			config_version++;
+
+			err = save_config(&current_cfg, sizeof(current_cfg));
+			if (err) {
+				LOG_WRN("Configuration not stored, error: %d",
+					err);
+			}
 		}
 
 		/* Distribute the configuration to other modules regardless
@@ -713,11 +1622,12 @@ static void on_cloud_state_connected(struct data_msg_data *msg)
 		 */
 		config_distribute(DATA_EVT_CONFIG_READY);
 
-		/* Acknowledge configuration to cloud if there has been a change
-		 * in the current device configuration.
+		/* Report changed and rejected configuration fields to cloud.
+		 * Rejected fields are reported with the current value so that
+		 * the cloud can tell that the desired value was not applied.
 		 */
-		if (config_change) {
-			config_send();
+		if (changed | rejected) {
+			config_send(changed | rejected);
 		} else {
 			LOG_WRN("No change in current device configuration");
 		}
@@ -731,6 +1641,35 @@ static void on_all_states(struct data_msg_data *msg)
 		config_distribute(DATA_EVT_CONFIG_INIT);
 	}
 
+	if (IS_EVENT(msg, data, DATA_EVT_TRACKING_EXPIRED)) {
+		int err;
+
+		if (!current_cfg.tracking_mode) {
+			return;
+		}
+
+		LOG_WRN("Tracking duration passed, Tracking mode disabled");
+
+		current_cfg.tracking_mode = false;
+		config_version++;
+		tracking_latch_set(true);
+
+		err = save_config(&current_cfg, sizeof(current_cfg));
+		if (err) {
+			LOG_WRN("Configuration not stored, error: %d", err);
+		}
+
+		track_segment_close();
+		config_distribute(DATA_EVT_CONFIG_READY);
+
+		if (state == STATE_CLOUD_CONNECTED) {
+			config_send(CLOUD_DATA_CFG_TRACKING_MODE);
+			track_send();
+		}
+
+		return;
+	}
+
 	if (IS_EVENT(msg, util, UTIL_EVT_SHUTDOWN_REQUEST)) {
 		/* The module doesn't have anything to shut down and can
 		 * report back immediately.
@@ -786,7 +1725,12 @@ static void on_all_states(struct data_msg_data *msg)
 		modem_stat.fw = msg->module.modem.data.modem_static.modem_fw;
 		modem_stat.iccid = msg->module.modem.data.modem_static.iccid;
 		modem_stat.ts = msg->module.modem.data.modem_static.timestamp;
-		modem_stat.queued = true;
+		modem_stat_hash = msg->module.modem.data.modem_static.hash;
+		modem_stat.queued = (modem_stat_hash != modem_stat_acked_hash);
+
+		if (!modem_stat.queued) {
+			LOG_DBG("Static modem data unchanged, not published");
+		}
 
 		data_status_set(APP_DATA_MODEM_STATIC);
 	}
@@ -796,25 +1740,72 @@ static void on_all_states(struct data_msg_data *msg)
 	}
 
 	if (IS_EVENT(msg, modem, MODEM_EVT_MODEM_DYNAMIC_DATA_READY)) {
+		struct modem_module_dynamic_modem_data *dynamic =
+				&msg->module.modem.data.modem_dynamic;
 		struct cloud_data_modem_dynamic new_modem_data = {
-			.area = msg->module.modem.data.modem_dynamic.area_code,
-			.cell = msg->module.modem.data.modem_dynamic.cell_id,
-			.ip = msg->module.modem.data.modem_dynamic.ip_address,
-			.mccmnc = msg->module.modem.data.modem_dynamic.mccmnc,
-			.rsrp = msg->module.modem.data.modem_dynamic.rsrp,
-			.ts = msg->module.modem.data.modem_dynamic.timestamp,
+			.area = dynamic->area_code,
+			.cell = dynamic->cell_id,
+			.ip = dynamic->ip_address,
+			.mccmnc = dynamic->mccmnc,
+			.rsrp = dynamic->rsrp,
+			.radio_cost = dynamic->radio_cost,
+			.radio_day = dynamic->radio_day,
+			.radio_other = dynamic->radio_other,
+			.radio = IS_ENABLED(CONFIG_DATA_RADIO_TELEMETRY),
+			.ts = dynamic->timestamp,
 			.queued = true
 		};
 
-		cloud_codec_populate_modem_dynamic_buffer(
+		if (modem_dyn_delta_check(&new_modem_data)) {
+			cloud_codec_populate_modem_dynamic_buffer(
 						modem_dyn_buf,
 						&new_modem_data,
 						&head_modem_dyn_buf,
 						ARRAY_SIZE(modem_dyn_buf));
+		}
+
+		/* The link quality is sampled once per sample cycle. */
+		if (new_modem_data.rsrp != 0) {
+			rsrp_latest = new_modem_data.rsrp - RSRP_OFFSET_DBM;
+			rsrp_history_add(rsrp_latest);
+		}
 
 		data_status_set(APP_DATA_MODEM_DYNAMIC);
 	}
 
+	if (IS_EVENT(msg, modem, MODEM_EVT_LTE_CELL_UPDATE)) {
+		struct cloud_data_cell_trail new_cell_trail_data = {
+			.cell = msg->module.modem.data.cell.cell_id,
+			.area = msg->module.modem.data.cell.tac,
+			.ts = k_uptime_get(),
+			.queued = true
+		};
+
+		cloud_codec_populate_cell_trail_buffer(
+						cell_trail_buf,
+						&new_cell_trail_data,
+						&head_cell_trail_buf,
+						ARRAY_SIZE(cell_trail_buf));
+	}
+
+	/* The RSRP of a new cell is reported after the cell change. */
+	if (IS_EVENT(msg, modem, MODEM_EVT_LTE_RSRP_UPDATE)) {
+		struct cloud_data_cell_trail *entry =
+					&cell_trail_buf[head_cell_trail_buf];
+
+		if (entry->queued && (entry->rsrp == 0)) {
+			entry->rsrp = msg->module.modem.data.rsrp;
+		}
+
+		rsrp_latest = msg->module.modem.data.rsrp;
+
+		/* Retry deferred batch uploads as soon as the link improves. */
+		if (defer.active && (state == STATE_CLOUD_CONNECTED)) {
+			batch_send();
+			track_send();
+		}
+	}
+
 	if (IS_EVENT(msg, modem, MODEM_EVT_BATTERY_DATA_NOT_READY)) {
 		data_status_set(APP_DATA_BATTERY);
 	}
@@ -826,9 +1817,12 @@ static void on_all_states(struct data_msg_data *msg)
 			.queued = true
 		};
 
-		cloud_codec_populate_bat_buffer(bat_buf, &new_battery_data,
-						&head_bat_buf,
-						ARRAY_SIZE(bat_buf));
+		if (bat_delta_check(new_battery_data.bat)) {
+			cloud_codec_populate_bat_buffer(bat_buf,
+							&new_battery_data,
+							&head_bat_buf,
+							ARRAY_SIZE(bat_buf));
+		}
 
 		data_status_set(APP_DATA_BATTERY);
 	}
@@ -841,10 +1835,14 @@ static void on_all_states(struct data_msg_data *msg)
 			.queued = true
 		};
 
-		cloud_codec_populate_sensor_buffer(sensors_buf,
-						   &new_sensor_data,
-						   &head_sensor_buf,
-						   ARRAY_SIZE(sensors_buf));
+		if (env_delta_check(new_sensor_data.temp,
+				    new_sensor_data.hum)) {
+			cloud_codec_populate_sensor_buffer(
+						sensors_buf,
+						&new_sensor_data,
+						&head_sensor_buf,
+						ARRAY_SIZE(sensors_buf));
+		}
 
 		data_status_set(APP_DATA_ENVIRONMENTAL);
 	}
@@ -853,17 +1851,45 @@ static void on_all_states(struct data_msg_data *msg)
 		data_status_set(APP_DATA_ENVIRONMENTAL);
 	}
 
-	if (IS_EVENT(msg, sensor, SENSOR_EVT_MOVEMENT_DATA_READY)) {
+	if (IS_EVENT(msg, sensor, SENSOR_EVT_ACTIVITY_DATA_READY)) {
+		struct cloud_data_activity new_activity_data = {
+			.rest = msg->module.sensor.data.activity.rest,
+			.walk = msg->module.sensor.data.activity.walk,
+			.run = msg->module.sensor.data.activity.run,
+			.jump = msg->module.sensor.data.activity.jump,
+			.ts = msg->module.sensor.data.activity.timestamp,
+			.queued = true
+		};
+
+		cloud_codec_populate_activity_buffer(activity_buf,
+						     &new_activity_data,
+						     &head_activity_buf,
+						     ARRAY_SIZE(activity_buf));
+	}
+
+	if (IS_EVENT(msg, sensor, SENSOR_EVT_MOVEMENT_WINDOW_READY)) {
 		if (current_cfg.active_mode) {
 			/* Do not store movement data in active mode. */
 			return;
 		}
 
+		if (IS_ENABLED(CONFIG_ACTIVITY_CLASSIFIER)) {
+			/* Movement is reported as activity summaries. */
+			return;
+		}
+
 		struct cloud_data_accelerometer new_movement_data = {
-			.values[0] = msg->module.sensor.data.accel.values[0],
-			.values[1] = msg->module.sensor.data.accel.values[1],
-			.values[2] = msg->module.sensor.data.accel.values[2],
-			.ts = msg->module.sensor.data.accel.timestamp,
+			.values[0] = msg->module.sensor.data.window.values[0],
+			.values[1] = msg->module.sensor.data.window.values[1],
+			.values[2] = msg->module.sensor.data.window.values[2],
+			.peak[0] = msg->module.sensor.data.window.peak[0],
+			.peak[1] = msg->module.sensor.data.window.peak[1],
+			.peak[2] = msg->module.sensor.data.window.peak[2],
+			.ts = msg->module.sensor.data.window.start,
+			.duration = msg->module.sensor.data.window.end -
+				    msg->module.sensor.data.window.start,
+			.count = MIN(msg->module.sensor.data.window.count,
+				     UINT16_MAX),
 			.queued = true
 		};
 
@@ -881,6 +1907,9 @@ static void on_all_states(struct data_msg_data *msg)
 			.longi = msg->module.gps.data.gps.longitude,
 			.spd = msg->module.gps.data.gps.speed,
 			.gps_ts = msg->module.gps.data.gps.timestamp,
+			.reused = msg->module.gps.data.gps.reused,
+			.age = msg->module.gps.data.gps.age,
+			.estimated = msg->module.gps.data.gps.estimated,
 			.queued = true
 		};
 
@@ -895,8 +1924,38 @@ static void on_all_states(struct data_msg_data *msg)
 		data_status_set(APP_DATA_GNSS);
 	}
 
+	if (IS_EVENT(msg, gps, GPS_EVT_TRACK_DATA_READY)) {
+		/* Fixes can arrive after Tracking mode has been disabled
+		 * and the last segment has been closed.
+		 */
+		if (!current_cfg.tracking_mode) {
+			return;
+		}
+
+		track_point_add(&msg->module.gps.data.gps);
+
+		if (state == STATE_CLOUD_CONNECTED) {
+			track_send();
+		}
+	}
+
 	if (IS_EVENT(msg, cloud, CLOUD_EVT_DATA_ACK)) {
+		if ((modem_stat_pending != NULL) &&
+		    (msg->module.cloud.data.ptr == modem_stat_pending)) {
+			modem_stat_pending = NULL;
+			static_hash_save(modem_stat_pending_hash);
+		}
+
 		pending_data_ack(msg->module.cloud.data.ptr);
+
+		if (state == STATE_CLOUD_CONNECTED) {
+			if (config_fields_unsent) {
+				config_send(config_fields_unsent);
+			}
+
+			track_send();
+		}
+
 		return;
 	}
 }
@@ -913,6 +1972,7 @@ static void module_thread_fn(void)
 	state_set(STATE_CLOUD_DISCONNECTED);
 
 	k_delayed_work_init(&data_send_work, data_send_work_fn);
+	k_delayed_work_init(&tracking_expiry_work, tracking_expiry_work_fn);
 
 	err = setup();
 	if (err) {
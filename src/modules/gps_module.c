@@ -10,6 +10,20 @@
 #include <date_time.h>
 #include <event_manager.h>
 #include <drivers/gps.h>
+#include <settings/settings.h>
+
+#if defined(CONFIG_GPS_MODULE_INJECT_POSITION)
+#include <math.h>
+#include <nrf_socket.h>
+#endif
+
+#if defined(CONFIG_POSITION_FILTER)
+#include "position_filter.h"
+#endif
+
+#if defined(CONFIG_LOCATION_CACHE)
+#include "location_cache.h"
+#endif
 
 #define MODULE gps_module
 
@@ -18,6 +32,8 @@
 #include "events/gps_module_event.h"
 #include "events/data_module_event.h"
 #include "events/util_module_event.h"
+#include "events/modem_module_event.h"
+#include "events/sensor_module_event.h"
 
 #include <logging/log.h>
 LOG_MODULE_REGISTER(MODULE, CONFIG_GPS_MODULE_LOG_LEVEL);
@@ -27,12 +43,66 @@ LOG_MODULE_REGISTER(MODULE, CONFIG_GPS_MODULE_LOG_LEVEL);
  */
 #define GPS_INTERVAL_MAX 1800
 
+/* Start strategy name used in the time to first fix statistics. */
+#if defined(CONFIG_GPS_MODULE_KEEP_PERIODIC)
+#define START_STRATEGY "periodic"
+#elif defined(CONFIG_GPS_MODULE_INJECT_POSITION)
+#define START_STRATEGY "inject"
+#else
+#define START_STRATEGY "stop"
+#endif
+
+#if defined(CONFIG_GPS_MODULE_INJECT_POSITION)
+/* GPS epoch, 6 January 1980, in UNIX seconds and the current GPS-UTC leap
+ * second offset.
+ */
+#define GPS_EPOCH_UNIX_S	315964800
+#define GPS_UTC_LEAP_SECONDS	18
+#define SEC_PER_DAY		86400
+
+/* Assumed maximum speed in m/s since the last fix. Used to derive the
+ * uncertainty of an injected position.
+ */
+#define INJECT_SPEED_MAX	30
+#endif
+
+#if defined(CONFIG_GPS_MODULE_ADAPTIVE_TIMEOUT)
+#define GPS_SETTINGS_KEY		"gps_module"
+#define GPS_SETTINGS_HISTORY_KEY	"history"
+
+/* Width and number of bins in the time to fix histograms. The last bin holds
+ * all fixes slower than the second to last bin.
+ */
+#define TTF_BIN_WIDTH_SEC		5
+#define TTF_BIN_COUNT			24
+
+/* Minimum number of fixes in a histogram before it is used. */
+#define TTF_SAMPLES_MIN			5
+
+/* When a histogram holds this many fixes all bins are halved, so that recent
+ * searches weigh more than old ones.
+ */
+#define TTF_SAMPLES_MAX			64
+
+/* Ephemerides are valid for about two hours. A search started within this
+ * time after a fix or an A-GPS request is considered a hot start.
+ */
+#define HOT_START_WINDOW_MS		(2 * 60 * 60 * MSEC_PER_SEC)
+
+#define CELL_HISTORY_COUNT		8
+
+/* Number of searches between each time the search history is stored. */
+#define HISTORY_SAVE_INTERVAL		10
+#endif /* CONFIG_GPS_MODULE_ADAPTIVE_TIMEOUT */
+
 struct gps_msg_data {
 	union {
 		struct app_module_event app;
 		struct data_module_event data;
 		struct util_module_event util;
 		struct gps_module_event gps;
+		struct modem_module_event modem;
+		struct sensor_module_event sensor;
 	} module;
 };
 
@@ -45,7 +115,8 @@ static enum state_type {
 /* GPS module sub states. */
 static enum sub_state_type {
 	SUB_STATE_IDLE,
-	SUB_STATE_SEARCH
+	SUB_STATE_SEARCH,
+	SUB_STATE_TRACKING
 } sub_state;
 
 /* GPS device. Used to identify the GPS driver in the sensor API. */
@@ -53,22 +124,184 @@ static const struct device *gps_dev;
 
 /* nRF9160 GPS driver configuration. */
 static struct gps_config gps_cfg = {
+#if defined(CONFIG_GPS_MODULE_FIX_REFINE)
+	/* Keep the receiver running after the first fix so that the position
+	 * can be refined. The search timeout is enforced by the module.
+	 */
+	.nav_mode = GPS_NAV_MODE_CONTINUOUS,
+#else
 	.nav_mode = GPS_NAV_MODE_PERIODIC,
+#endif
 	.power_mode = GPS_POWER_MODE_DISABLED,
 	.interval = GPS_INTERVAL_MAX
 };
 
+/* Uptime when the current GPS search was started. Used to calculate the
+ * time to fix.
+ */
+static int64_t search_start_time;
+
+/* GPS timeout in the device configuration. Upper bound of the search
+ * timeout.
+ */
+static uint32_t gps_timeout_max;
+
+/* Time the GPS has been searching and number of fixes since boot. */
+static uint32_t search_time_total_ms;
+static uint32_t fix_count;
+
+/* Time the current search has been blocked by LTE activity. blocked_start
+ * is the uptime when the GPS was blocked, 0 if it is not blocked.
+ */
+static uint32_t blocked_time_ms;
+static int64_t blocked_start;
+
+/* Set while the LTE link is in RRC connected mode. */
+static bool rrc_connected;
+
+/* Time to first fix statistics. */
+static struct ttff_stats {
+	/* Set from the start of a search until its first fix. */
+	bool pending;
+	uint32_t last_ms;
+	uint32_t total_ms;
+	uint32_t min_ms;
+	uint32_t max_ms;
+	uint32_t fixes;
+	uint32_t searches;
+} ttff;
+
+#if defined(CONFIG_GPS_MODULE_KEEP_PERIODIC)
+/* Set while the GPS runs in periodic mode between searches. Read from the
+ * GPS driver callback.
+ */
+static bool background;
+#endif
+
+#if defined(CONFIG_GPS_MODULE_INJECT_POSITION)
+/* Last fix, injected as assistance data when a search starts. */
+static struct gps_module_data position_last;
+#endif
+
+/* Set when Tracking mode is enabled in the device configuration. */
+static bool tracking_mode;
+
+/* Set while the GPS runs continuously in Tracking mode. Read from the GPS
+ * driver callback.
+ */
+static bool tracking;
+
+/* Time between fixes stored in Tracking mode. */
+static uint32_t tracking_interval_ms;
+
+/* Uptime of the last fix stored in Tracking mode, 0 if none. */
+static int64_t track_fix_time;
+
+/* Last fix stored in Tracking mode. Used to answer requests for GPS data. */
+static struct gps_module_data track_fix_last;
+
+#if defined(CONFIG_GPS_MODULE_WAIT_FOR_RRC_IDLE)
+/* Set when a search is postponed until the LTE link goes to RRC idle. */
+static bool search_pending;
+static struct k_delayed_work search_pending_work;
+#endif
+
+#if defined(CONFIG_GPS_MODULE_ADAPTIVE_TIMEOUT)
+enum search_condition {
+	SEARCH_CONDITION_HOT,
+	SEARCH_CONDITION_COLD,
+	SEARCH_CONDITION_COUNT
+};
+
+struct cell_history {
+	uint32_t cell_id;
+	/* Consecutive searches without a fix in the cell. */
+	uint8_t failures;
+	/* Consecutive searches skipped in the cell. */
+	uint8_t skipped;
+};
+
+/* Search history, stored to flash. */
+static struct search_history {
+	/* Time to fix histograms for hot and cold starts. */
+	uint8_t ttf_bins[SEARCH_CONDITION_COUNT][TTF_BIN_COUNT];
+	/* Set if the last search under a condition timed out with
+	 * a shortened timeout. The next search uses the full timeout.
+	 */
+	bool full_timeout[SEARCH_CONDITION_COUNT];
+	struct cell_history cells[CELL_HISTORY_COUNT];
+	/* Cell entry replaced when a new cell is added. */
+	uint8_t cell_next;
+} history;
+
+static enum search_condition condition;
+static uint32_t current_cell_id;
+static int64_t last_fix_time;
+static int64_t last_agps_request_time;
+static int searches_since_save;
+#endif /* CONFIG_GPS_MODULE_ADAPTIVE_TIMEOUT */
+
+#if defined(CONFIG_GPS_MODULE_FIX_REFINE)
+/* Fixes acquired in the current search. Positions are averaged weighted by
+ * the inverse of the squared accuracy of each epoch.
+ */
+static struct fix_refine {
+	bool active;
+	uint8_t epochs;
+	int64_t first_fix_time;
+	double weight_sum;
+	double latitude_sum;
+	double longitude_sum;
+	double altitude_sum;
+	struct gps_pvt best;
+} refine;
+#endif
+
+#if defined(CONFIG_GPS_MODULE_MOTION_GATING)
+/* Last acquired fix and the uptime when it was acquired. */
+static struct gps_module_data fix_last;
+static int64_t fix_last_time;
+#endif
+
+#if defined(CONFIG_GPS_MODULE_MOTION_EVENTS)
+/* Set when the sensor module has reported that the device has not moved
+ * since the uptime in still_since.
+ */
+static bool still;
+static int64_t still_since;
+#endif
+
+#if defined(CONFIG_LOCATION_CACHE)
+/* Current serving cell, used as key in the location cache. */
+static struct location_cache_cell cell_current;
+#endif
+
+/* GPS module message queue. */
+#define GPS_QUEUE_ENTRY_COUNT		10
+#define GPS_QUEUE_BYTE_ALIGNMENT	4
+
+K_MSGQ_DEFINE(msgq_gps, sizeof(struct gps_msg_data),
+	      GPS_QUEUE_ENTRY_COUNT, GPS_QUEUE_BYTE_ALIGNMENT);
+
 static struct module_data self = {
 	.name = "gps",
-	.msg_q = NULL,
+	.msg_q = &msgq_gps,
 };
 
 /* Forward declarations. */
 static void message_handler(struct gps_msg_data *data);
 static void search_start(void);
 static void search_stop(void);
+#if defined(CONFIG_GPS_MODULE_FIX_REFINE)
+static void fix_refine_add(struct gps_pvt *gps_data);
+static void fix_refine_check(void);
+static bool fix_refine_timeout(void);
+#endif
+static void track_fix_add(struct gps_pvt *gps_data);
+static void ttff_update(void);
 static void time_set(struct gps_pvt *gps_data);
-static void data_send(struct gps_pvt *gps_data);
+static void data_send(struct gps_pvt *gps_data,
+		      enum gps_module_event_type type);
 
 /* Convenience functions used in internal state handling. */
 static char *state2str(enum state_type new_state)
@@ -90,6 +323,8 @@ static char *sub_state2str(enum sub_state_type new_state)
 		return "SUB_STATE_IDLE";
 	case SUB_STATE_SEARCH:
 		return "SUB_STATE_SEARCH";
+	case SUB_STATE_TRACKING:
+		return "SUB_STATE_TRACKING";
 	default:
 		return "Unknown";
 	}
@@ -126,41 +361,65 @@ static void sub_state_set(enum sub_state_type new_state)
 /* Handlers */
 static bool event_handler(const struct event_header *eh)
 {
+	struct gps_msg_data msg = {0};
+	bool enqueue_msg = false;
+	uint32_t start = k_cycle_get_32();
+
 	if (is_app_module_event(eh)) {
 		struct app_module_event *event = cast_app_module_event(eh);
-		struct gps_msg_data msg = {
-			.module.app = *event
-		};
 
-		message_handler(&msg);
+		msg.module.app = *event;
+		enqueue_msg = true;
 	}
 
 	if (is_data_module_event(eh)) {
 		struct data_module_event *event = cast_data_module_event(eh);
-		struct gps_msg_data msg = {
-			.module.data = *event
-		};
 
-		message_handler(&msg);
+		msg.module.data = *event;
+		enqueue_msg = true;
 	}
 
 	if (is_util_module_event(eh)) {
 		struct util_module_event *event = cast_util_module_event(eh);
-		struct gps_msg_data msg = {
-			.module.util = *event
-		};
 
-		message_handler(&msg);
+		msg.module.util = *event;
+		enqueue_msg = true;
 	}
 
 	if (is_gps_module_event(eh)) {
 		struct gps_module_event *event = cast_gps_module_event(eh);
-		struct gps_msg_data msg = {
-			.module.gps = *event
-		};
 
-		message_handler(&msg);
+		msg.module.gps = *event;
+		enqueue_msg = true;
+	}
+
+	if (is_modem_module_event(eh)) {
+		struct modem_module_event *event = cast_modem_module_event(eh);
+
+		msg.module.modem = *event;
+		enqueue_msg = true;
+	}
+
+#if defined(CONFIG_GPS_MODULE_MOTION_EVENTS)
+	if (is_sensor_module_event(eh)) {
+		struct sensor_module_event *event =
+				cast_sensor_module_event(eh);
+
+		msg.module.sensor = *event;
+		enqueue_msg = true;
 	}
+#endif
+
+	if (enqueue_msg) {
+		int err = module_enqueue_msg(&self, &msg);
+
+		if (err) {
+			LOG_ERR("Message could not be enqueued");
+			SEND_ERROR(gps, GPS_EVT_ERROR_CODE, err);
+		}
+	}
+
+	module_handler_stats_update(&self, start);
 
 	return false;
 }
@@ -176,17 +435,47 @@ static void gps_event_handler(const struct device *dev, struct gps_event *evt)
 		break;
 	case GPS_EVT_SEARCH_TIMEOUT:
 		LOG_DBG("GPS_EVT_SEARCH_TIMEOUT");
+#if defined(CONFIG_GPS_MODULE_KEEP_PERIODIC)
+		if (background) {
+			break;
+		}
+#endif
+#if defined(CONFIG_GPS_MODULE_FIX_REFINE)
+		if (fix_refine_timeout()) {
+			break;
+		}
+#endif
 		SEND_EVENT(gps, GPS_EVT_TIMEOUT);
 		search_stop();
 		break;
 	case GPS_EVT_PVT:
 		/* Don't spam logs */
+#if defined(CONFIG_GPS_MODULE_FIX_REFINE)
+		fix_refine_check();
+#endif
 		break;
 	case GPS_EVT_PVT_FIX:
+		if (tracking) {
+			track_fix_add(&evt->pvt);
+			break;
+		}
+#if defined(CONFIG_GPS_MODULE_KEEP_PERIODIC)
+		if (background) {
+			LOG_DBG("Background fix");
+			break;
+		}
+#endif
+		ttff_update();
+#if defined(CONFIG_GPS_MODULE_FIX_REFINE)
+		fix_refine_add(&evt->pvt);
+#else
 		LOG_DBG("GPS_EVT_PVT_FIX");
+		LOG_DBG("Time to fix: %lld ms",
+			k_uptime_get() - search_start_time);
 		time_set(&evt->pvt);
-		data_send(&evt->pvt);
+		data_send(&evt->pvt, GPS_EVT_DATA_READY);
 		search_stop();
+#endif
 		break;
 	case GPS_EVT_NMEA:
 		/* Don't spam logs */
@@ -196,9 +485,14 @@ static void gps_event_handler(const struct device *dev, struct gps_event *evt)
 		break;
 	case GPS_EVT_OPERATION_BLOCKED:
 		LOG_DBG("GPS_EVT_OPERATION_BLOCKED");
+		blocked_start = k_uptime_get();
 		break;
 	case GPS_EVT_OPERATION_UNBLOCKED:
 		LOG_DBG("GPS_EVT_OPERATION_UNBLOCKED");
+		if (blocked_start != 0) {
+			blocked_time_ms += k_uptime_get() - blocked_start;
+			blocked_start = 0;
+		}
 		break;
 	case GPS_EVT_AGPS_DATA_NEEDED:
 		LOG_DBG("GPS_EVT_AGPS_DATA_NEEDED");
@@ -218,7 +512,8 @@ static void gps_event_handler(const struct device *dev, struct gps_event *evt)
 }
 
 /* Static module functions. */
-static void data_send(struct gps_pvt *gps_data)
+static void data_send(struct gps_pvt *gps_data,
+		      enum gps_module_event_type type)
 {
 	struct gps_module_event *gps_module_event = new_gps_module_event();
 
@@ -229,21 +524,515 @@ static void data_send(struct gps_pvt *gps_data)
 	gps_module_event->data.gps.speed = gps_data->speed;
 	gps_module_event->data.gps.heading = gps_data->heading;
 	gps_module_event->data.gps.timestamp = k_uptime_get();
-	gps_module_event->type = GPS_EVT_DATA_READY;
+	gps_module_event->type = type;
 
 	EVENT_SUBMIT(gps_module_event);
 }
 
+#if defined(CONFIG_GPS_MODULE_ADAPTIVE_TIMEOUT)
+static int settings_set(const char *key, size_t len,
+			settings_read_cb read_cb, void *cb_arg)
+{
+	int err;
+
+	if ((strcmp(key, GPS_SETTINGS_HISTORY_KEY) == 0) &&
+	    (len == sizeof(history))) {
+		err = read_cb(cb_arg, &history, sizeof(history));
+		if (err < 0) {
+			LOG_ERR("Failed to load search history, error: %d",
+				err);
+			return err;
+		}
+
+		LOG_DBG("Search history loaded from flash");
+	}
+
+	return 0;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(MODULE, GPS_SETTINGS_KEY, NULL, settings_set,
+			       NULL, NULL);
+
+static void history_save(void)
+{
+	int err;
+
+	err = settings_save_one(GPS_SETTINGS_KEY "/" GPS_SETTINGS_HISTORY_KEY,
+				&history, sizeof(history));
+	if (err) {
+		LOG_WRN("Search history not stored, error: %d", err);
+		return;
+	}
+
+	searches_since_save = 0;
+}
+
+static struct cell_history *cell_history_get(uint32_t cell_id, bool add)
+{
+	struct cell_history *cell;
+
+	for (size_t i = 0; i < ARRAY_SIZE(history.cells); i++) {
+		if (history.cells[i].cell_id == cell_id) {
+			return &history.cells[i];
+		}
+	}
+
+	if (!add) {
+		return NULL;
+	}
+
+	cell = &history.cells[history.cell_next];
+	history.cell_next = (history.cell_next + 1) % ARRAY_SIZE(history.cells);
+
+	*cell = (struct cell_history) {
+		.cell_id = cell_id
+	};
+
+	return cell;
+}
+
+static enum search_condition search_condition_get(void)
+{
+	int64_t now = k_uptime_get();
+
+	if ((last_fix_time != 0) &&
+	    (now - last_fix_time < HOT_START_WINDOW_MS)) {
+		return SEARCH_CONDITION_HOT;
+	}
+
+	if ((last_agps_request_time != 0) &&
+	    (now - last_agps_request_time < HOT_START_WINDOW_MS)) {
+		return SEARCH_CONDITION_HOT;
+	}
+
+	return SEARCH_CONDITION_COLD;
+}
+
+/* Derive the search timeout from the time to fix that covers 90 percent of
+ * earlier fixes under the same condition, with one bin of margin.
+ */
+static uint32_t search_timeout_get(enum search_condition cond)
+{
+	uint32_t total = 0;
+	uint32_t count = 0;
+	uint32_t timeout;
+	size_t i;
+
+	if (history.full_timeout[cond]) {
+		return gps_timeout_max;
+	}
+
+	for (i = 0; i < TTF_BIN_COUNT; i++) {
+		total += history.ttf_bins[cond][i];
+	}
+
+	if (total < TTF_SAMPLES_MIN) {
+		return gps_timeout_max;
+	}
+
+	for (i = 0; i < TTF_BIN_COUNT; i++) {
+		count += history.ttf_bins[cond][i];
+
+		if (count * 10 >= total * 9) {
+			break;
+		}
+	}
+
+	timeout = (i + 2) * TTF_BIN_WIDTH_SEC;
+
+	return CLAMP(timeout, CONFIG_GPS_MODULE_ADAPTIVE_TIMEOUT_MIN,
+		     gps_timeout_max);
+}
+
+/* Returns true if the search history indicates that a search will fail in
+ * the current cell.
+ */
+static bool search_skip(void)
+{
+	struct cell_history *cell;
+
+	/* Searches are not skipped before the serving cell is known. */
+	if (current_cell_id == 0) {
+		return false;
+	}
+
+	cell = cell_history_get(current_cell_id, false);
+	if (cell == NULL) {
+		return false;
+	}
+
+	if ((cell->failures >= CONFIG_GPS_MODULE_SEARCH_SKIP_FAILURES) &&
+	    (cell->skipped < CONFIG_GPS_MODULE_SEARCH_SKIP_MAX)) {
+		cell->skipped++;
+		return true;
+	}
+
+	cell->skipped = 0;
+
+	return false;
+}
+
+/* Update the search history. The time to fix is the time until the first
+ * fix of the search, without the time spent refining it. Failures are only
+ * counted per cell when the serving cell is known.
+ */
+static void history_update(bool fix, uint32_t time_to_fix_ms)
+{
+	struct cell_history *cell = NULL;
+	uint8_t *bins = history.ttf_bins[condition];
+	uint32_t total = 0;
+	size_t bin;
+
+	if (current_cell_id != 0) {
+		cell = cell_history_get(current_cell_id, true);
+	}
+
+	if (!fix) {
+		if ((cell != NULL) && (cell->failures < UINT8_MAX)) {
+			cell->failures++;
+		}
+
+		history.full_timeout[condition] =
+				gps_cfg.timeout < gps_timeout_max;
+		goto save;
+	}
+
+	if (cell != NULL) {
+		cell->failures = 0;
+	}
+
+	history.full_timeout[condition] = false;
+	last_fix_time = k_uptime_get();
+
+	bin = MIN(time_to_fix_ms / MSEC_PER_SEC / TTF_BIN_WIDTH_SEC,
+		  TTF_BIN_COUNT - 1);
+	bins[bin]++;
+
+	for (size_t i = 0; i < TTF_BIN_COUNT; i++) {
+		total += bins[i];
+	}
+
+	if (total >= TTF_SAMPLES_MAX) {
+		for (size_t i = 0; i < TTF_BIN_COUNT; i++) {
+			bins[i] /= 2;
+		}
+	}
+
+save:
+	searches_since_save++;
+
+	if (searches_since_save >= HISTORY_SAVE_INTERVAL) {
+		history_save();
+	}
+}
+#endif /* CONFIG_GPS_MODULE_ADAPTIVE_TIMEOUT */
+
+/* Called from the GPS driver callback on the first fix of a search. */
+static void ttff_update(void)
+{
+	if (!ttff.pending) {
+		return;
+	}
+
+	ttff.pending = false;
+	ttff.last_ms = k_uptime_get() - search_start_time;
+	ttff.total_ms += ttff.last_ms;
+	ttff.min_ms = ttff.fixes == 0 ? ttff.last_ms :
+				       MIN(ttff.min_ms, ttff.last_ms);
+	ttff.max_ms = MAX(ttff.max_ms, ttff.last_ms);
+	ttff.fixes++;
+}
+
+static void search_time_update(bool fix)
+{
+	uint32_t search_time_ms = k_uptime_get() - search_start_time;
+
+	search_time_total_ms += search_time_ms;
+
+	if (fix) {
+		fix_count++;
+	}
+
+	if (fix_count > 0) {
+		LOG_DBG("GPS search time per fix: %d seconds",
+			search_time_total_ms / MSEC_PER_SEC / fix_count);
+	}
+
+	ttff.searches++;
+	ttff.pending = false;
+
+	if (ttff.fixes > 0) {
+		LOG_INF("TTFF (%s): last %d ms, average %d ms",
+			START_STRATEGY, fix ? ttff.last_ms : 0,
+			ttff.total_ms / ttff.fixes);
+		LOG_INF("TTFF (%s): min %d ms, max %d ms", START_STRATEGY,
+			ttff.min_ms, ttff.max_ms);
+		LOG_INF("TTFF (%s): %d fixes in %d searches", START_STRATEGY,
+			ttff.fixes, ttff.searches);
+	}
+
+#if defined(CONFIG_GPS_MODULE_ADAPTIVE_TIMEOUT)
+	history_update(fix, fix ? ttff.last_ms : search_time_ms);
+#endif
+}
+
+#if defined(CONFIG_GPS_MODULE_FIX_REFINE)
+static void fix_refine_publish(struct gps_pvt *gps_data)
+{
+	refine.active = false;
+
+	time_set(gps_data);
+	data_send(gps_data, GPS_EVT_DATA_READY);
+	search_stop();
+}
+
+/* Add a fix to the current search. The fix is published right away if its
+ * accuracy is good enough. Otherwise the weighted average is published when
+ * the configured number of epochs have been added.
+ */
+static void fix_refine_add(struct gps_pvt *gps_data)
+{
+	struct gps_pvt average;
+	double weight;
+
+	if (!refine.active) {
+		return;
+	}
+
+	if (refine.epochs == 0) {
+		LOG_DBG("Time to fix: %lld ms",
+			k_uptime_get() - search_start_time);
+	}
+
+	if (gps_data->accuracy <= CONFIG_GPS_MODULE_FIX_ACCURACY_THRESHOLD) {
+		LOG_DBG("Fix accuracy: %d m", (int)gps_data->accuracy);
+		fix_refine_publish(gps_data);
+		return;
+	}
+
+	if ((refine.epochs == 0) ||
+	    (gps_data->accuracy < refine.best.accuracy)) {
+		refine.best = *gps_data;
+	}
+
+	if (refine.epochs == 0) {
+		refine.first_fix_time = k_uptime_get();
+	}
+
+	weight = 1.0 / MAX(gps_data->accuracy * gps_data->accuracy, 1.0);
+
+	refine.weight_sum += weight;
+	refine.latitude_sum += weight * gps_data->latitude;
+	refine.longitude_sum += weight * gps_data->longitude;
+	refine.altitude_sum += weight * gps_data->altitude;
+	refine.epochs++;
+
+	if (refine.epochs < CONFIG_GPS_MODULE_FIX_REFINE_EPOCHS) {
+		fix_refine_check();
+		return;
+	}
+
+	/* Speed, heading and time are taken from the latest epoch. The
+	 * accuracy of the best epoch is reported for the averaged position.
+	 */
+	average = *gps_data;
+	average.latitude = refine.latitude_sum / refine.weight_sum;
+	average.longitude = refine.longitude_sum / refine.weight_sum;
+	average.altitude = refine.altitude_sum / refine.weight_sum;
+	average.accuracy = refine.best.accuracy;
+
+	LOG_DBG("Averaged %d epochs, accuracy: %d m", refine.epochs,
+		(int)average.accuracy);
+
+	fix_refine_publish(&average);
+}
+
+/* Publish the best fix when the refinement window has run out, and end the
+ * search when the search timeout has expired.
+ */
+static void fix_refine_check(void)
+{
+	int64_t now = k_uptime_get();
+
+	if (!refine.active) {
+		return;
+	}
+
+	if ((refine.epochs > 0) &&
+	    (now - refine.first_fix_time >=
+	     CONFIG_GPS_MODULE_FIX_REFINE_WINDOW * MSEC_PER_SEC)) {
+		LOG_DBG("Refinement window expired, best accuracy: %d m",
+			(int)refine.best.accuracy);
+		fix_refine_publish(&refine.best);
+		return;
+	}
+
+	if (now - search_start_time >= gps_cfg.timeout * MSEC_PER_SEC) {
+		if (fix_refine_timeout()) {
+			return;
+		}
+
+		refine.active = false;
+
+		SEND_EVENT(gps, GPS_EVT_TIMEOUT);
+		search_stop();
+	}
+}
+
+/* Publish the best fix of the search if there is one. Returns true if a fix
+ * was published.
+ */
+static bool fix_refine_timeout(void)
+{
+	if (!refine.active || (refine.epochs == 0)) {
+		return false;
+	}
+
+	LOG_DBG("Search timeout, best accuracy: %d m",
+		(int)refine.best.accuracy);
+	fix_refine_publish(&refine.best);
+
+	return true;
+}
+#endif /* CONFIG_GPS_MODULE_FIX_REFINE */
+
+#if defined(CONFIG_GPS_MODULE_KEEP_PERIODIC)
+/* Leave the GPS in periodic mode after a search. Fixes acquired in the
+ * background are not published.
+ */
+static void background_start(void)
+{
+	int err;
+	struct gps_config cfg = {
+		.nav_mode = GPS_NAV_MODE_PERIODIC,
+		.power_mode = GPS_POWER_MODE_DISABLED,
+		.interval = CONFIG_GPS_MODULE_PERIODIC_INTERVAL,
+		.timeout = gps_timeout_max
+	};
+
+	background = true;
+
+	err = gps_start(gps_dev, &cfg);
+	if (err) {
+		LOG_WRN("Failed to start GPS in periodic mode, error: %d", err);
+		background = false;
+	}
+}
+#endif
+
+#if defined(CONFIG_GPS_MODULE_INJECT_POSITION)
+/* Encode an uncertainty in meters as K in r = 10 * (1.1^K - 1). */
+static uint8_t uncertainty_encode(double meters)
+{
+	double k = ceil(log(meters / 10.0 + 1.0) / log(1.1));
+
+	return MIN(MAX(k, 0), 127);
+}
+
+/* Write the current time and the last position to the GPS. */
+static void position_inject(void)
+{
+	int err;
+	int64_t now;
+	int64_t gps_time_ms;
+	double uncertainty;
+	nrf_gnss_agps_data_system_time_and_sv_tow_t sys_time = {0};
+	nrf_gnss_agps_data_location_t location = {0};
+
+	err = date_time_now(&now);
+	if (err) {
+		LOG_DBG("No valid time to inject");
+		return;
+	}
+
+	gps_time_ms = now - (int64_t)GPS_EPOCH_UNIX_S * MSEC_PER_SEC +
+		      GPS_UTC_LEAP_SECONDS * MSEC_PER_SEC;
+
+	sys_time.date_day = gps_time_ms / MSEC_PER_SEC / SEC_PER_DAY;
+	sys_time.time_full_s = (gps_time_ms / MSEC_PER_SEC) % SEC_PER_DAY;
+	sys_time.time_frac_ms = gps_time_ms % MSEC_PER_SEC;
+
+	err = gps_agps_write(gps_dev, GPS_AGPS_GPS_SYSTEM_CLOCK_AND_TOWS,
+			     &sys_time, sizeof(sys_time));
+	if (err) {
+		LOG_WRN("Failed to inject time, error: %d", err);
+		return;
+	}
+
+	if (position_last.timestamp == 0) {
+		return;
+	}
+
+	uncertainty = position_last.accuracy + INJECT_SPEED_MAX *
+		      (k_uptime_get() - position_last.timestamp) /
+		      MSEC_PER_SEC;
+
+	location.latitude = position_last.latitude / 90.0 * (1 << 23);
+	location.longitude = position_last.longitude / 360.0 * (1 << 24);
+	location.altitude = position_last.altitude;
+	location.unc_semimajor = uncertainty_encode(uncertainty);
+	location.unc_semiminor = location.unc_semimajor;
+	location.unc_altitude = 255;
+	location.confidence = 68;
+
+	err = gps_agps_write(gps_dev, GPS_AGPS_LOCATION, &location,
+			     sizeof(location));
+	if (err) {
+		LOG_WRN("Failed to inject position, error: %d", err);
+		return;
+	}
+
+	LOG_DBG("Injected time and position, uncertainty: %d m",
+		(int)uncertainty);
+}
+#endif
+
 static void search_start(void)
 {
 	int err;
 
+	gps_cfg.timeout = gps_timeout_max;
+
+#if defined(CONFIG_GPS_MODULE_ADAPTIVE_TIMEOUT)
+	if (search_skip()) {
+		LOG_WRN("Recent searches in cell %d failed, search skipped",
+			current_cell_id);
+		SEND_EVENT(gps, GPS_EVT_TIMEOUT);
+		return;
+	}
+
+	condition = search_condition_get();
+	gps_cfg.timeout = search_timeout_get(condition);
+
+	LOG_DBG("GPS search timeout: %d seconds, %s start", gps_cfg.timeout,
+		condition == SEARCH_CONDITION_HOT ? "hot" : "cold");
+#endif
+
+	search_start_time = k_uptime_get();
+	blocked_time_ms = 0;
+	blocked_start = 0;
+	ttff.pending = true;
+
+#if defined(CONFIG_GPS_MODULE_FIX_REFINE)
+	refine = (struct fix_refine) {
+		.active = true
+	};
+#endif
+
+#if defined(CONFIG_GPS_MODULE_KEEP_PERIODIC)
+	background = false;
+#endif
+
 	err = gps_start(gps_dev, &gps_cfg);
 	if (err) {
 		LOG_WRN("Failed to start GPS, error: %d", err);
 		return;
 	}
 
+#if defined(CONFIG_GPS_MODULE_INJECT_POSITION)
+	position_inject();
+#endif
+
 	SEND_EVENT(gps, GPS_EVT_ACTIVE);
 }
 
@@ -257,9 +1046,124 @@ static void search_stop(void)
 		return;
 	}
 
+	if (blocked_start != 0) {
+		blocked_time_ms += k_uptime_get() - blocked_start;
+		blocked_start = 0;
+	}
+
+	LOG_DBG("GPS blocked by LTE for %d ms of %lld ms search",
+		blocked_time_ms, k_uptime_get() - search_start_time);
+
 	SEND_EVENT(gps, GPS_EVT_INACTIVE);
 }
 
+#if defined(CONFIG_GPS_MODULE_WAIT_FOR_RRC_IDLE)
+/* Start a postponed search. Called when the LTE link goes to RRC idle, or
+ * when it has not done so within the maximum wait time.
+ */
+static void search_pending_start(void)
+{
+	if (!search_pending) {
+		return;
+	}
+
+	search_pending = false;
+	search_start();
+}
+
+/* The search is started from the module thread, which owns the GPS
+ * configuration and search state.
+ */
+static void search_pending_work_fn(struct k_work *work)
+{
+	SEND_EVENT(gps, GPS_EVT_RRC_IDLE_WAIT_EXPIRED);
+}
+#endif
+
+/* Store a fix in Tracking mode if the tracking interval has passed since the
+ * last stored fix. Fixes arrive every second, half a second of slack keeps
+ * jitter from skipping a fix.
+ */
+static void track_fix_add(struct gps_pvt *gps_data)
+{
+	int64_t now = k_uptime_get();
+
+	if ((track_fix_time != 0) &&
+	    (now - track_fix_time < tracking_interval_ms - MSEC_PER_SEC / 2)) {
+		return;
+	}
+
+	if (track_fix_time == 0) {
+		LOG_DBG("Time to first tracking fix: %lld ms",
+			now - search_start_time);
+		time_set(gps_data);
+	}
+
+	track_fix_time = now;
+	data_send(gps_data, GPS_EVT_TRACK_DATA_READY);
+}
+
+/* Run the GPS continuously until Tracking mode is disabled. GPS_EVT_ACTIVE is
+ * not sent, as that would hold back cloud communication for the duration of
+ * Tracking mode.
+ */
+static void tracking_start(void)
+{
+	int err;
+	struct gps_config cfg = {
+		.nav_mode = GPS_NAV_MODE_CONTINUOUS,
+		.power_mode = GPS_POWER_MODE_DISABLED
+	};
+
+#if defined(CONFIG_GPS_MODULE_WAIT_FOR_RRC_IDLE)
+	if (search_pending) {
+		search_pending = false;
+		k_delayed_work_cancel(&search_pending_work);
+		SEND_EVENT(gps, GPS_EVT_TIMEOUT);
+	}
+#endif
+
+	search_start_time = k_uptime_get();
+	track_fix_time = 0;
+	track_fix_last.timestamp = 0;
+	tracking = true;
+
+#if defined(CONFIG_GPS_MODULE_KEEP_PERIODIC)
+	background = false;
+#endif
+
+	err = gps_start(gps_dev, &cfg);
+	if (err) {
+		LOG_WRN("Failed to start GPS tracking, error: %d", err);
+		tracking = false;
+		return;
+	}
+
+	LOG_DBG("GPS tracking started, interval: %d ms", tracking_interval_ms);
+
+	sub_state_set(SUB_STATE_TRACKING);
+}
+
+static void tracking_stop(void)
+{
+	int err;
+
+	err = gps_stop(gps_dev);
+	if (err) {
+		LOG_WRN("Failed to stop GPS tracking, error: %d", err);
+	}
+
+	tracking = false;
+
+	LOG_DBG("GPS tracking stopped");
+
+	sub_state_set(SUB_STATE_IDLE);
+
+#if defined(CONFIG_GPS_MODULE_KEEP_PERIODIC)
+	background_start();
+#endif
+}
+
 static void time_set(struct gps_pvt *gps_data)
 {
 	/* Change datetime.year and datetime.month to accommodate the
@@ -306,14 +1210,210 @@ static int setup(void)
 		return err;
 	}
 
+#if defined(CONFIG_GPS_MODULE_WAIT_FOR_RRC_IDLE)
+	k_delayed_work_init(&search_pending_work, search_pending_work_fn);
+#endif
+
+#if defined(CONFIG_GPS_MODULE_ADAPTIVE_TIMEOUT)
+	err = settings_subsys_init();
+	if (err) {
+		LOG_ERR("settings_subsys_init, error: %d", err);
+		return err;
+	}
+
+	err = settings_load_subtree(GPS_SETTINGS_KEY);
+	if (err) {
+		LOG_ERR("settings_load_subtree, error: %d", err);
+		return err;
+	}
+#endif
+
+#if defined(CONFIG_LOCATION_CACHE)
+	err = location_cache_init();
+	if (err) {
+		LOG_ERR("location_cache_init, error: %d", err);
+		return err;
+	}
+#endif
+
 	return 0;
 }
 
+#if defined(CONFIG_GPS_MODULE_MOTION_GATING)
+/* Send the last fix if the device has not moved since it was acquired and it
+ * is not older than the configured maximum age. Returns true if the fix was
+ * sent.
+ */
+static bool fix_reuse(void)
+{
+	struct gps_module_event *gps_module_event;
+	int64_t age = k_uptime_get() - fix_last_time;
+
+	if ((fix_last_time == 0) || !still || (fix_last_time < still_since)) {
+		return false;
+	}
+
+	if (age >= CONFIG_GPS_MODULE_FIX_REUSE_AGE_MAX * MSEC_PER_SEC) {
+		LOG_DBG("Last fix is too old to be reused");
+		return false;
+	}
+
+	LOG_DBG("No movement since last fix, reusing fix from %lld seconds ago",
+		age / MSEC_PER_SEC);
+
+	gps_module_event = new_gps_module_event();
+	gps_module_event->data.gps = fix_last;
+	gps_module_event->data.gps.timestamp = k_uptime_get();
+	gps_module_event->data.gps.reused = true;
+	gps_module_event->data.gps.age = age / MSEC_PER_SEC;
+	gps_module_event->type = GPS_EVT_DATA_READY;
+
+	EVENT_SUBMIT(gps_module_event);
+
+	return true;
+}
+#endif
+
+#if defined(CONFIG_LOCATION_CACHE)
+static void location_cache_store_msg(struct gps_module_data *fix)
+{
+	int err;
+	struct location_cache_position position = {
+		.latitude = fix->latitude,
+		.longitude = fix->longitude,
+		.altitude = fix->altitude,
+		.accuracy = fix->accuracy
+	};
+
+	err = date_time_now(&position.time);
+	if (err) {
+		position.time = 0;
+	}
+
+	location_cache_store(&cell_current, &position);
+}
+
+/* Send the cached position of the current cell if the device is still, the
+ * position is not older than the configured maximum age and it was acquired
+ * after the device last moved. Returns true if a cached position was sent.
+ */
+static bool location_cache_send(void)
+{
+	int err;
+	int64_t now;
+	int64_t age;
+	int64_t still_time;
+	struct location_cache_position position;
+	struct gps_module_event *gps_module_event;
+
+	if (!still || (cell_current.cell_id == 0)) {
+		return false;
+	}
+
+	err = location_cache_lookup(&cell_current, &position);
+	if (err) {
+		return false;
+	}
+
+	if ((position.time == 0) || date_time_now(&now)) {
+		return false;
+	}
+
+	age = now - position.time;
+	still_time = now - (k_uptime_get() - still_since);
+
+	if (age >= CONFIG_LOCATION_CACHE_AGE_MAX * (int64_t)MSEC_PER_SEC) {
+		LOG_DBG("Cached position is too old to be reported");
+		return false;
+	}
+
+	if (position.time < still_time) {
+		LOG_DBG("Device has moved since the position was cached");
+		return false;
+	}
+
+	gps_module_event = new_gps_module_event();
+	gps_module_event->data.gps.latitude = position.latitude;
+	gps_module_event->data.gps.longitude = position.longitude;
+	gps_module_event->data.gps.altitude = position.altitude;
+	gps_module_event->data.gps.accuracy = position.accuracy;
+	gps_module_event->data.gps.timestamp = k_uptime_get();
+	gps_module_event->data.gps.reused = true;
+	gps_module_event->data.gps.age = age / MSEC_PER_SEC;
+	gps_module_event->type = GPS_EVT_DATA_READY;
+
+	EVENT_SUBMIT(gps_module_event);
+
+	return true;
+}
+#endif
+
+#if defined(CONFIG_POSITION_FILTER)
+/* Send the estimated position if its uncertainty is within the configured
+ * maximum and the fix it is based on is not older than the configured
+ * maximum age. Returns true if the estimate was sent.
+ */
+static bool position_estimate_send(void)
+{
+	int err;
+	int64_t age;
+	struct position_filter_estimate estimate;
+	struct gps_module_event *gps_module_event;
+
+	err = position_filter_estimate_get(k_uptime_get(), &estimate);
+	if (err) {
+		return false;
+	}
+
+	age = k_uptime_get() - estimate.fix_time;
+
+	if (age >= CONFIG_POSITION_FILTER_AGE_MAX * MSEC_PER_SEC) {
+		LOG_DBG("Last fix is too old for an estimate, starting search");
+		return false;
+	}
+
+	if (estimate.uncertainty > CONFIG_POSITION_FILTER_UNCERTAINTY_MAX) {
+		LOG_DBG("Position uncertainty %d m, starting search",
+			(int)estimate.uncertainty);
+		return false;
+	}
+
+	LOG_DBG("Sending estimated position, uncertainty: %d m",
+		(int)estimate.uncertainty);
+
+	gps_module_event = new_gps_module_event();
+	gps_module_event->data.gps.latitude = estimate.latitude;
+	gps_module_event->data.gps.longitude = estimate.longitude;
+	gps_module_event->data.gps.altitude = estimate.altitude;
+	gps_module_event->data.gps.accuracy = estimate.uncertainty;
+	gps_module_event->data.gps.speed = estimate.speed;
+	gps_module_event->data.gps.heading = estimate.heading;
+	gps_module_event->data.gps.timestamp = k_uptime_get();
+	gps_module_event->data.gps.estimated = true;
+	gps_module_event->type = GPS_EVT_DATA_READY;
+
+	EVENT_SUBMIT(gps_module_event);
+
+	return true;
+}
+
+static void position_filter_fix_add_msg(struct gps_module_data *fix)
+{
+	position_filter_fix_add(fix->latitude, fix->longitude, fix->altitude,
+				fix->accuracy, fix->speed, fix->heading,
+				fix->timestamp);
+}
+#endif
+
 /* Message handler for STATE_INIT. */
 static void on_state_init(struct gps_msg_data *msg)
 {
 	if (IS_EVENT(msg, data, DATA_EVT_CONFIG_INIT)) {
-		gps_cfg.timeout = msg->module.data.data.cfg.gps_timeout;
+		gps_timeout_max = msg->module.data.data.cfg.gps_timeout;
+		tracking_mode = msg->module.data.data.cfg.tracking_mode;
+		tracking_interval_ms =
+			msg->module.data.data.cfg.tracking_interval *
+			MSEC_PER_SEC;
 		state_set(STATE_RUNNING);
 	}
 }
@@ -322,7 +1422,21 @@ static void on_state_init(struct gps_msg_data *msg)
 static void on_state_running(struct gps_msg_data *msg)
 {
 	if (IS_EVENT(msg, data, DATA_EVT_CONFIG_READY)) {
-		gps_cfg.timeout = msg->module.data.data.cfg.gps_timeout;
+		gps_timeout_max = msg->module.data.data.cfg.gps_timeout;
+		tracking_mode = msg->module.data.data.cfg.tracking_mode;
+		tracking_interval_ms =
+			msg->module.data.data.cfg.tracking_interval *
+			MSEC_PER_SEC;
+
+		/* A search in progress is allowed to finish before Tracking
+		 * mode is entered.
+		 */
+		if (tracking_mode && (sub_state == SUB_STATE_IDLE)) {
+			tracking_start();
+		} else if (!tracking_mode &&
+			   (sub_state == SUB_STATE_TRACKING)) {
+			tracking_stop();
+		}
 	}
 }
 
@@ -331,6 +1445,36 @@ static void on_state_running_gps_search(struct gps_msg_data *msg)
 {
 	if (IS_EVENT(msg, gps, GPS_EVT_INACTIVE)) {
 		sub_state_set(SUB_STATE_IDLE);
+
+		if (tracking_mode) {
+			tracking_start();
+			return;
+		}
+
+#if defined(CONFIG_GPS_MODULE_KEEP_PERIODIC)
+		background_start();
+#endif
+	}
+
+	if (IS_EVENT(msg, gps, GPS_EVT_DATA_READY)) {
+		search_time_update(true);
+
+#if defined(CONFIG_GPS_MODULE_INJECT_POSITION)
+		position_last = msg->module.gps.data.gps;
+#endif
+
+#if defined(CONFIG_GPS_MODULE_MOTION_GATING)
+		fix_last = msg->module.gps.data.gps;
+		fix_last_time = k_uptime_get();
+#endif
+
+#if defined(CONFIG_LOCATION_CACHE)
+		location_cache_store_msg(&msg->module.gps.data.gps);
+#endif
+	}
+
+	if (IS_EVENT(msg, gps, GPS_EVT_TIMEOUT)) {
+		search_time_update(false);
 	}
 
 	if (IS_EVENT(msg, app, APP_EVT_DATA_GET)) {
@@ -358,8 +1502,90 @@ static void on_state_running_gps_idle(struct gps_msg_data *msg)
 			return;
 		}
 
+#if defined(CONFIG_GPS_MODULE_MOTION_GATING)
+		if (fix_reuse()) {
+			return;
+		}
+#endif
+
+#if defined(CONFIG_LOCATION_CACHE)
+		if (location_cache_send()) {
+			return;
+		}
+#endif
+
+#if defined(CONFIG_POSITION_FILTER)
+		if (position_estimate_send()) {
+			return;
+		}
+#endif
+
+#if defined(CONFIG_GPS_MODULE_WAIT_FOR_RRC_IDLE)
+		/* GPS is blocked while LTE is active. Postpone the search
+		 * until the RRC connection has been released.
+		 */
+		if (rrc_connected) {
+			LOG_DBG("LTE in RRC connected mode, postponing search");
+
+			search_pending = true;
+			k_delayed_work_submit(&search_pending_work,
+				K_SECONDS(CONFIG_GPS_MODULE_RRC_IDLE_WAIT_MAX));
+			return;
+		}
+#endif
+
 		search_start();
 	}
+
+#if defined(CONFIG_GPS_MODULE_WAIT_FOR_RRC_IDLE)
+	if (IS_EVENT(msg, modem, MODEM_EVT_LTE_RRC_IDLE)) {
+		k_delayed_work_cancel(&search_pending_work);
+		search_pending_start();
+	}
+
+	if (IS_EVENT(msg, gps, GPS_EVT_RRC_IDLE_WAIT_EXPIRED)) {
+		LOG_DBG("LTE still in RRC connected mode, starting GPS search");
+		search_pending_start();
+	}
+#endif
+}
+
+/* Message handler for SUB_STATE_TRACKING. */
+static void on_state_running_gps_tracking(struct gps_msg_data *msg)
+{
+	if (IS_EVENT(msg, gps, GPS_EVT_TRACK_DATA_READY)) {
+		track_fix_last = msg->module.gps.data.gps;
+
+#if defined(CONFIG_GPS_MODULE_INJECT_POSITION)
+		position_last = msg->module.gps.data.gps;
+#endif
+
+#if defined(CONFIG_GPS_MODULE_MOTION_GATING)
+		fix_last = msg->module.gps.data.gps;
+		fix_last_time = k_uptime_get();
+#endif
+	}
+
+	if (IS_EVENT(msg, app, APP_EVT_DATA_GET)) {
+		if (!gps_data_requested(msg->module.app.data_list,
+					msg->module.app.count)) {
+			return;
+		}
+
+		/* Answer with the last fix stored in the track. */
+		if (track_fix_last.timestamp == 0) {
+			SEND_EVENT(gps, GPS_EVT_TIMEOUT);
+			return;
+		}
+
+		struct gps_module_event *gps_module_event =
+				new_gps_module_event();
+
+		gps_module_event->data.gps = track_fix_last;
+		gps_module_event->type = GPS_EVT_DATA_READY;
+
+		EVENT_SUBMIT(gps_module_event);
+	}
 }
 
 /* Message handler for all states. */
@@ -378,7 +1604,84 @@ static void on_all_states(struct gps_msg_data *msg)
 		}
 	}
 
+	if (IS_EVENT(msg, modem, MODEM_EVT_LTE_RRC_CONNECTED)) {
+		rrc_connected = true;
+	}
+
+	if (IS_EVENT(msg, modem, MODEM_EVT_LTE_RRC_IDLE)) {
+		rrc_connected = false;
+	}
+
+#if defined(CONFIG_GPS_MODULE_ADAPTIVE_TIMEOUT)
+	if (IS_EVENT(msg, modem, MODEM_EVT_LTE_CELL_UPDATE)) {
+		current_cell_id = msg->module.modem.data.cell.cell_id;
+	}
+
+	if (IS_EVENT(msg, gps, GPS_EVT_AGPS_NEEDED)) {
+		last_agps_request_time = k_uptime_get();
+	}
+#endif
+
+#if defined(CONFIG_LOCATION_CACHE)
+	if (IS_EVENT(msg, modem, MODEM_EVT_LTE_CELL_UPDATE)) {
+		cell_current.cell_id = msg->module.modem.data.cell.cell_id;
+		cell_current.tac = msg->module.modem.data.cell.tac;
+	}
+
+	if (IS_EVENT(msg, modem, MODEM_EVT_LTE_RSRP_UPDATE)) {
+		cell_current.rsrp = msg->module.modem.data.rsrp;
+	}
+#endif
+
+#if defined(CONFIG_GPS_MODULE_MOTION_EVENTS)
+	if (IS_EVENT(msg, sensor, SENSOR_EVT_MOVEMENT_DATA_READY)) {
+		still = false;
+	}
+
+	if (IS_EVENT(msg, sensor, SENSOR_EVT_MOVEMENT_INACTIVITY)) {
+		still = true;
+		still_since = msg->module.sensor.data.inactivity.since;
+	}
+#endif
+
+#if defined(CONFIG_POSITION_FILTER)
+	/* In Tracking mode the fixes are added as GPS_EVT_TRACK_DATA_READY. */
+	if (IS_EVENT(msg, gps, GPS_EVT_DATA_READY) &&
+	    (sub_state != SUB_STATE_TRACKING) &&
+	    !msg->module.gps.data.gps.reused &&
+	    !msg->module.gps.data.gps.estimated) {
+		position_filter_fix_add_msg(&msg->module.gps.data.gps);
+	}
+
+	if (IS_EVENT(msg, gps, GPS_EVT_TRACK_DATA_READY)) {
+		position_filter_fix_add_msg(&msg->module.gps.data.gps);
+	}
+
+	/* Only the first trigger of a movement window is reported right away,
+	 * the peak of the whole window is added when the window is closed.
+	 */
+	if (IS_EVENT(msg, sensor, SENSOR_EVT_MOVEMENT_DATA_READY)) {
+		position_filter_motion_add(msg->module.sensor.data.accel.values,
+					   k_uptime_get());
+	}
+
+	if (IS_EVENT(msg, sensor, SENSOR_EVT_MOVEMENT_WINDOW_READY)) {
+		position_filter_motion_add(msg->module.sensor.data.window.peak,
+					   k_uptime_get());
+	}
+
+	if (IS_EVENT(msg, sensor, SENSOR_EVT_MOVEMENT_INACTIVITY)) {
+		position_filter_still(k_uptime_get());
+	}
+#endif
+
 	if (IS_EVENT(msg, util, UTIL_EVT_SHUTDOWN_REQUEST)) {
+#if defined(CONFIG_GPS_MODULE_ADAPTIVE_TIMEOUT)
+		history_save();
+#endif
+#if defined(CONFIG_LOCATION_CACHE)
+		location_cache_save();
+#endif
 		SEND_EVENT(gps, GPS_EVT_SHUTDOWN_READY);
 	}
 }
@@ -397,6 +1700,9 @@ static void message_handler(struct gps_msg_data *msg)
 		case SUB_STATE_IDLE:
 			on_state_running_gps_idle(msg);
 			break;
+		case SUB_STATE_TRACKING:
+			on_state_running_gps_tracking(msg);
+			break;
 		default:
 			LOG_ERR("Unknown GPS module sub state.");
 			break;
@@ -412,8 +1718,28 @@ static void message_handler(struct gps_msg_data *msg)
 	on_all_states(msg);
 }
 
+static void module_thread_fn(void)
+{
+	struct gps_msg_data msg;
+
+	self.thread_id = k_current_get();
+
+	while (true) {
+		module_get_next_msg(&self, &msg);
+		message_handler(&msg);
+	}
+}
+
+K_THREAD_DEFINE(gps_module_thread, CONFIG_GPS_THREAD_STACK_SIZE,
+		module_thread_fn, NULL, NULL, NULL,
+		K_LOWEST_APPLICATION_THREAD_PRIO, 0, 0);
+
 EVENT_LISTENER(MODULE, event_handler);
 EVENT_SUBSCRIBE(MODULE, app_module_event);
 EVENT_SUBSCRIBE(MODULE, data_module_event);
 EVENT_SUBSCRIBE(MODULE, util_module_event);
 EVENT_SUBSCRIBE(MODULE, gps_module_event);
+EVENT_SUBSCRIBE(MODULE, modem_module_event);
+#if defined(CONFIG_GPS_MODULE_MOTION_EVENTS)
+EVENT_SUBSCRIBE(MODULE, sensor_module_event);
+#endif
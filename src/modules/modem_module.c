@@ -7,10 +7,13 @@
 #include <zephyr.h>
 #include <stdio.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <event_manager.h>
+#include <sys/crc.h>
 
 #include <modem/lte_lc.h>
 #include <modem/modem_info.h>
+#include <modem/at_cmd.h>
 
 #define MODULE modem_module
 
@@ -31,6 +34,7 @@ struct modem_msg_data {
 	union {
 		struct app_module_event app;
 		struct cloud_module_event cloud;
+		struct data_module_event data;
 		struct util_module_event util;
 		struct modem_module_event modem;
 	} module;
@@ -47,8 +51,115 @@ static enum state_type {
 /* Struct that holds data from the modem information module. */
 static struct modem_param_info modem_param;
 
+/* Modem information requests made while handling one APP_EVT_DATA_GET. Each
+ * request is a series of AT command round trips to the modem.
+ */
+static struct {
+	/* Full modem_info_params_get() sweeps. */
+	uint32_t sweeps;
+	/* Single parameter queries. */
+	uint32_t queries;
+	/* Total time spent waiting for the modem in milliseconds. */
+	uint32_t time;
+} at_stats;
+
+/* Static modem data only changes with a new SIM card, band or firmware. It is
+ * read from the sweep that is made for dynamic modem data, and a separate
+ * sweep is only made if static data is requested before the cache is valid.
+ */
+static struct {
+	bool valid;
+	uint32_t hash;
+} static_cache;
+
+/* PSM and eDRX parameters requested from the network, in seconds. A value of
+ * -1 means that the feature is not requested.
+ */
+static struct {
+	int tau;
+	int active_time;
+	int edrx;
+} power_saving_req = {
+	.tau = -1,
+	.active_time = -1,
+	.edrx = -1
+};
+
+/* Uptime when the cloud module reported that all publications have been
+ * acknowledged, 0 if not reported in the current RRC connection. With
+ * CLOUD_RAI the RRC connection is expected to be released right after.
+ */
+static int64_t uplink_done;
+
+#if defined(CONFIG_CLOUD_RAI)
+#define RAI_RELEASE_TIME CONFIG_CLOUD_RAI_RELEASE_TIME
+#else
+#define RAI_RELEASE_TIME 0
+#endif
+
+/* Time spent in RRC connected mode. Connections released right after the
+ * uplink is done with RAI are counted separately from connections released
+ * by the network inactivity timer.
+ */
+static struct {
+	int64_t connected;
+	uint32_t rai_count;
+	uint32_t rai_time;
+	uint32_t timer_count;
+	uint32_t timer_time;
+} rrc_stats;
+
+#define RADIO_DAY_MS (24LL * 60 * 60 * MSEC_PER_SEC)
+
+/* Radio cost accounting. The time of each RRC connection is attributed to
+ * the publications and downlink messages handled since the previous RRC
+ * release, since the connection is normally set up by the first of them.
+ * Connections without publications, such as tracking area updates, paging
+ * and downlink only connections, are accounted separately.
+ */
+static struct {
+	/* Publications, downlink messages and downlink bytes since the last
+	 * RRC release.
+	 */
+	uint32_t publishes;
+	uint32_t downlinks;
+	uint32_t downlink_bytes;
+	/* Cumulative RRC connected time in milliseconds. */
+	uint64_t total;
+	/* Connected time per publication of the last connection that carried
+	 * publications, in milliseconds.
+	 */
+	uint32_t cost;
+	/* Connected time in milliseconds since day_start, the uptime when the
+	 * current 24 hour period started.
+	 */
+	uint32_t day_time;
+	/* Part of day_time spent in connections without publications. */
+	uint32_t day_other;
+	int64_t day_start;
+} radio;
+
 /* Value that always holds the latest RSRP value. */
 static uint16_t rsrp_value_latest;
+
+/* Offset between raw RSRP values and RSRP in dBm. */
+#define RSRP_OFFSET_DBM 140
+
+/* %CESQ notifications can come in bursts. RSRP updates are submitted at most
+ * once per CONFIG_MODEM_RSRP_UPDATE_INTERVAL, and only if the RSRP has changed
+ * by CONFIG_MODEM_RSRP_UPDATE_THRESHOLD dB since the last update, so that
+ * they cannot fill the message queues of the subscribing modules.
+ */
+static struct {
+	/* Latest RSRP in dBm. */
+	int latest;
+	/* RSRP in dBm of the last update, valid if time is not 0. */
+	int sent;
+	/* 32-bit uptime of the last update. */
+	uint32_t time;
+} rsrp_update;
+
+static struct k_delayed_work rsrp_update_work;
 const k_tid_t module_thread;
 
 /* Modem module message queue. */
@@ -65,6 +176,8 @@ static struct module_data self = {
 
 /* Forward declarations. */
 static void send_cell_update(uint32_t cell_id, uint32_t tac);
+static void send_rsrp_update(int rsrp);
+static uint32_t rsrp_update_delay(void);
 static void send_psm_update(int tau, int active_time);
 static void send_edrx_update(float edrx, float ptw);
 
@@ -104,6 +217,7 @@ static bool event_handler(const struct event_header *eh)
 {
 	struct modem_msg_data msg = {0};
 	bool enqueue_msg = false;
+	uint32_t start = k_cycle_get_32();
 
 	if (is_modem_module_event(eh)) {
 		struct modem_module_event *evt = cast_modem_module_event(eh);
@@ -126,6 +240,25 @@ static bool event_handler(const struct event_header *eh)
 		enqueue_msg = true;
 	}
 
+	if (is_data_module_event(eh)) {
+		struct data_module_event *evt = cast_data_module_event(eh);
+
+		/* Only configuration and publication events are handled. */
+		switch (evt->type) {
+		case DATA_EVT_CONFIG_INIT:
+		case DATA_EVT_CONFIG_READY:
+		case DATA_EVT_CONFIG_SEND:
+		case DATA_EVT_DATA_SEND:
+		case DATA_EVT_DATA_SEND_BATCH:
+		case DATA_EVT_UI_DATA_SEND:
+			msg.module.data = *evt;
+			enqueue_msg = true;
+			break;
+		default:
+			break;
+		}
+	}
+
 	if (is_util_module_event(eh)) {
 		struct util_module_event *evt = cast_util_module_event(eh);
 
@@ -142,6 +275,8 @@ static bool event_handler(const struct event_header *eh)
 		}
 	}
 
+	module_handler_stats_update(&self, start);
+
 	return false;
 }
 
@@ -150,6 +285,9 @@ static void lte_evt_handler(const struct lte_lc_evt *const evt)
 	switch (evt->type) {
 	case LTE_LC_EVT_NW_REG_STATUS:
 		if (evt->nw_reg_status == LTE_LC_NW_REG_UICC_FAIL) {
+			/* A different SIM card might be inserted. */
+			static_cache.valid = false;
+
 			LOG_ERR("No SIM card detected!");
 			SEND_ERROR(modem, MODEM_EVT_ERROR, -ENOTSUP);
 			break;
@@ -190,6 +328,12 @@ static void lte_evt_handler(const struct lte_lc_evt *const evt)
 		LOG_DBG("RRC mode: %s",
 			evt->rrc_mode == LTE_LC_RRC_MODE_CONNECTED ?
 			"Connected" : "Idle");
+
+		if (evt->rrc_mode == LTE_LC_RRC_MODE_CONNECTED) {
+			SEND_EVENT(modem, MODEM_EVT_LTE_RRC_CONNECTED);
+		} else {
+			SEND_EVENT(modem, MODEM_EVT_LTE_RRC_IDLE);
+		}
 		break;
 	case LTE_LC_EVT_CELL_UPDATE:
 		LOG_DBG("LTE cell changed: Cell ID: %d, Tracking area: %d",
@@ -220,6 +364,13 @@ static void modem_rsrp_handler(char rsrp_value)
 
 	LOG_DBG("Incoming RSRP status message, RSRP value is %d",
 		rsrp_value_latest);
+
+	rsrp_update.latest = rsrp_value - RSRP_OFFSET_DBM;
+
+	/* The deadline does not move when the work is submitted again during
+	 * a burst.
+	 */
+	k_delayed_work_submit(&rsrp_update_work, K_MSEC(rsrp_update_delay()));
 }
 
 /* Static module functions. */
@@ -234,6 +385,45 @@ static void send_cell_update(uint32_t cell_id, uint32_t tac)
 	EVENT_SUBMIT(evt);
 }
 
+static void send_rsrp_update(int rsrp)
+{
+	struct modem_module_event *evt = new_modem_module_event();
+
+	evt->type = MODEM_EVT_LTE_RSRP_UPDATE;
+	evt->data.rsrp = rsrp;
+
+	EVENT_SUBMIT(evt);
+}
+
+/* Time left until an RSRP update can be submitted, in milliseconds. */
+static uint32_t rsrp_update_delay(void)
+{
+	uint32_t elapsed = k_uptime_get_32() - rsrp_update.time;
+	uint32_t interval = CONFIG_MODEM_RSRP_UPDATE_INTERVAL * MSEC_PER_SEC;
+
+	if ((rsrp_update.time == 0) || (elapsed >= interval)) {
+		return 0;
+	}
+
+	return interval - elapsed;
+}
+
+static void rsrp_update_work_fn(struct k_work *work)
+{
+	int rsrp = rsrp_update.latest;
+
+	if ((rsrp_update.time != 0) &&
+	    (abs(rsrp - rsrp_update.sent) <
+	     CONFIG_MODEM_RSRP_UPDATE_THRESHOLD)) {
+		return;
+	}
+
+	rsrp_update.sent = rsrp;
+	rsrp_update.time = MAX(k_uptime_get_32(), 1);
+
+	send_rsrp_update(rsrp);
+}
+
 static void send_psm_update(int tau, int active_time)
 {
 	struct modem_module_event *evt = new_modem_module_event();
@@ -280,17 +470,73 @@ static void check_modem_fw_version(void)
 	modem_fw_version_checked = true;
 }
 
-static int static_modem_data_get(void)
+/* Fetch all modem parameters into modem_param. Done at most once per
+ * APP_EVT_DATA_GET, static and dynamic modem data are read from the result.
+ */
+static int modem_info_sweep(void)
 {
 	int err;
+	int64_t start = k_uptime_get();
 
-	/* Request data from modem information module. */
 	err = modem_info_params_get(&modem_param);
+
+	at_stats.sweeps++;
+	at_stats.time += k_uptime_get() - start;
+
 	if (err) {
 		LOG_ERR("modem_info_params_get, error: %d", err);
 		return err;
 	}
 
+	return 0;
+}
+
+static uint32_t static_modem_data_hash(void)
+{
+	uint32_t hash;
+	const char *strings[] = {
+		CONFIG_CAT_TRACKER_APP_VERSION,
+		modem_param.device.board,
+		modem_param.device.modem_fw.value_string,
+		modem_param.sim.iccid.value_string
+	};
+	uint16_t values[] = {
+		modem_param.network.lte_mode.value,
+		modem_param.network.nbiot_mode.value,
+		modem_param.network.gps_mode.value,
+		modem_param.network.current_band.value
+	};
+
+	hash = crc32_ieee((const uint8_t *)values, sizeof(values));
+
+	for (size_t i = 0; i < ARRAY_SIZE(strings); i++) {
+		hash = crc32_ieee_update(hash, (const uint8_t *)strings[i],
+					 strlen(strings[i]));
+	}
+
+	return hash;
+}
+
+/* Returns true if the static modem data in the last sweep differs from the
+ * cached data.
+ */
+static bool static_cache_update(void)
+{
+	uint32_t hash = static_modem_data_hash();
+	bool changed = !static_cache.valid || (hash != static_cache.hash);
+
+	if (changed) {
+		LOG_DBG("Static modem data changed, hash: 0x%08x", hash);
+	}
+
+	static_cache.hash = hash;
+	static_cache.valid = true;
+
+	return changed;
+}
+
+static void static_modem_data_get(void)
+{
 	check_modem_fw_version();
 
 	struct modem_module_event *modem_module_event =
@@ -320,26 +566,17 @@ static int static_modem_data_get(void)
 	modem_module_event->data.modem_static.band =
 			modem_param.network.current_band.value;
 
+	modem_module_event->data.modem_static.hash = static_cache.hash;
+
 	modem_module_event->data.modem_static.timestamp = k_uptime_get();
 
 	modem_module_event->type = MODEM_EVT_MODEM_STATIC_DATA_READY;
 
 	EVENT_SUBMIT(modem_module_event);
-
-	return 0;
 }
 
-static int dynamic_modem_data_get(void)
+static void dynamic_modem_data_get(void)
 {
-	int err;
-
-	/* Request data from modem information module. */
-	err = modem_info_params_get(&modem_param);
-	if (err) {
-		LOG_ERR("modem_info_params_get, error: %d", err);
-		return err;
-	}
-
 	struct modem_module_event *modem_module_event =
 			new_modem_module_event();
 
@@ -358,13 +595,19 @@ static int dynamic_modem_data_get(void)
 	modem_module_event->data.modem_dynamic.area_code =
 			modem_param.network.area_code.value;
 
+	modem_module_event->data.modem_dynamic.radio_cost = radio.cost;
+
+	modem_module_event->data.modem_dynamic.radio_day =
+			radio.day_time / MSEC_PER_SEC;
+
+	modem_module_event->data.modem_dynamic.radio_other =
+			radio.day_other / MSEC_PER_SEC;
+
 	modem_module_event->data.modem_dynamic.timestamp = k_uptime_get();
 
 	modem_module_event->type = MODEM_EVT_MODEM_DYNAMIC_DATA_READY;
 
 	EVENT_SUBMIT(modem_module_event);
-
-	return 0;
 }
 
 static bool static_modem_data_requested(enum app_module_data_type *data_list,
@@ -403,24 +646,33 @@ static bool battery_data_requested(enum app_module_data_type *data_list,
 	return false;
 }
 
-static int battery_data_get(void)
+/* Battery voltage is taken from the sweep if one has been done for this
+ * APP_EVT_DATA_GET, otherwise it is queried on its own.
+ */
+static int battery_data_get(bool swept)
 {
 	int err;
+	uint16_t battery_voltage = modem_param.device.battery.value;
 
-	/* Replace this function with a function that specifically
-	 * requests battery.
-	 */
-	err = modem_info_params_get(&modem_param);
-	if (err) {
-		LOG_ERR("modem_info_params_get, error: %d", err);
-		return err;
+	if (!swept) {
+		int64_t start = k_uptime_get();
+
+		err = modem_info_short_get(MODEM_INFO_BATTERY,
+					   &battery_voltage);
+
+		at_stats.queries++;
+		at_stats.time += k_uptime_get() - start;
+
+		if (err < 0) {
+			LOG_ERR("modem_info_short_get, error: %d", err);
+			return err;
+		}
 	}
 
 	struct modem_module_event *modem_module_event =
 			new_modem_module_event();
 
-	modem_module_event->data.bat.battery_voltage =
-			modem_param.device.battery.value;
+	modem_module_event->data.bat.battery_voltage = battery_voltage;
 	modem_module_event->data.bat.timestamp = k_uptime_get();
 	modem_module_event->type = MODEM_EVT_BATTERY_DATA_READY;
 
@@ -444,6 +696,276 @@ static int configure_low_power(void)
 	return 0;
 }
 
+/* Timer units of the GPRS Timer 3 (periodic TAU) and GPRS Timer 2 (active
+ * time) information elements in 3GPP TS 24.008, ordered by duration. The
+ * timer value is encoded in 5 bits.
+ */
+struct timer_unit {
+	uint8_t code;
+	int seconds;
+};
+
+static const struct timer_unit tau_units[] = {
+	{ 0x3, 2 }, { 0x4, 30 }, { 0x5, 60 }, { 0x0, 600 },
+	{ 0x1, 3600 }, { 0x2, 36000 }, { 0x6, 1152000 }
+};
+
+static const struct timer_unit active_time_units[] = {
+	{ 0x0, 2 }, { 0x1, 60 }, { 0x2, 360 }
+};
+
+#define TIMER_VALUE_MAX 31
+
+/* LTE-M eDRX cycles in milliseconds, indexed by their 4 bit code in
+ * 3GPP TS 24.008.
+ */
+static const int edrx_cycles_ms[] = {
+	5120, 10240, 20480, 40960, 61440, 81920, 102400, 122880, 143360,
+	163840, 327680, 655360, 1310720, 2621440, 5242880, 10485760
+};
+
+static void bits_to_str(uint8_t value, size_t bits, char *buf)
+{
+	for (size_t i = 0; i < bits; i++) {
+		buf[i] = (value & BIT(bits - 1 - i)) ? '1' : '0';
+	}
+
+	buf[bits] = '\0';
+}
+
+/* Encodes the shortest timer that is at least the given number of seconds.
+ * Returns the encoded duration in seconds.
+ */
+static int timer_encode(const struct timer_unit *units, size_t count,
+			int seconds, char *buf)
+{
+	for (size_t i = 0; i < count; i++) {
+		int value = ceiling_fraction(seconds, units[i].seconds);
+
+		if (value <= TIMER_VALUE_MAX || i == count - 1) {
+			value = MIN(value, TIMER_VALUE_MAX);
+			bits_to_str((units[i].code << 5) | value, 8, buf);
+			return value * units[i].seconds;
+		}
+	}
+
+	return -1;
+}
+
+/* Decodes a timer given as a string of 8 bits. A deactivated timer decodes
+ * to 0 seconds.
+ */
+static int timer_decode(const struct timer_unit *units, size_t count,
+			const char *str)
+{
+	long bits = strtol(str, NULL, 2);
+
+	for (size_t i = 0; i < count; i++) {
+		if (units[i].code == ((bits >> 5) & 0x7)) {
+			return (bits & TIMER_VALUE_MAX) * units[i].seconds;
+		}
+	}
+
+	return 0;
+}
+
+/* Derive PSM and eDRX parameters from the device configuration. The build
+ * time periodic TAU and active time are the minimum. The periodic TAU is
+ * extended if the longest time between publications, including a GPS
+ * search, is longer, so that the modem does not wake up only to do a
+ * tracking area update. The active time, where the device can receive
+ * downlink data after a publication, is only extended in Active mode and if
+ * MODEM_PSM_ACTIVE_TIME_MAX is set. eDRX is used in the active time if it
+ * is long enough to fit two eDRX cycles.
+ */
+static void power_saving_configure(const struct cloud_data_cfg *cfg)
+{
+	int err;
+	int longest, tau, active_time, edrx = -1;
+	int tau_min = timer_decode(tau_units, ARRAY_SIZE(tau_units),
+				   CONFIG_LTE_PSM_REQ_RPTAU);
+	int active_time_min = timer_decode(active_time_units,
+					   ARRAY_SIZE(active_time_units),
+					   CONFIG_LTE_PSM_REQ_RAT);
+	char rptau[9], rat[9], edrx_str[5];
+
+	if (cfg->active_mode || cfg->tracking_mode) {
+		longest = cfg->active_wait_timeout;
+	} else {
+		longest = cfg->movement_timeout;
+	}
+
+	if (cfg->active_mode && !cfg->tracking_mode) {
+		active_time_min = MAX(active_time_min,
+				      MIN(cfg->active_wait_timeout / 4,
+					  CONFIG_MODEM_PSM_ACTIVE_TIME_MAX));
+	}
+
+	tau = timer_encode(tau_units, ARRAY_SIZE(tau_units),
+			   MAX(tau_min, longest + cfg->gps_timeout), rptau);
+	active_time = timer_encode(active_time_units,
+				   ARRAY_SIZE(active_time_units),
+				   active_time_min, rat);
+
+	for (int i = ARRAY_SIZE(edrx_cycles_ms) - 1; i >= 0; i--) {
+		if (2 * edrx_cycles_ms[i] <= active_time * MSEC_PER_SEC) {
+			edrx = edrx_cycles_ms[i] / MSEC_PER_SEC;
+			bits_to_str(i, 4, edrx_str);
+			break;
+		}
+	}
+
+	if ((tau != power_saving_req.tau) ||
+	    (active_time != power_saving_req.active_time)) {
+		err = lte_lc_psm_param_set(rptau, rat);
+		if (err) {
+			LOG_ERR("lte_lc_psm_param_set, error: %d", err);
+			return;
+		}
+
+		err = lte_lc_psm_req(true);
+		if (err) {
+			LOG_ERR("lte_lc_psm_req, error: %d", err);
+			return;
+		}
+
+		power_saving_req.tau = tau;
+		power_saving_req.active_time = active_time;
+
+		LOG_INF("PSM requested, TAU: %d s, active time: %d s",
+			tau, active_time);
+	}
+
+	if (edrx == power_saving_req.edrx) {
+		return;
+	}
+
+	if (edrx > 0) {
+		err = lte_lc_edrx_param_set(edrx_str);
+		if (err) {
+			LOG_ERR("lte_lc_edrx_param_set, error: %d", err);
+			return;
+		}
+	}
+
+	err = lte_lc_edrx_req(edrx > 0);
+	if (err) {
+		LOG_ERR("lte_lc_edrx_req, error: %d", err);
+		return;
+	}
+
+	power_saving_req.edrx = edrx;
+
+	if (edrx > 0) {
+		LOG_INF("eDRX requested, cycle: %d s", edrx);
+	} else {
+		LOG_INF("eDRX disabled, active time too short");
+	}
+}
+
+/* The network can grant other values than requested. */
+static void power_saving_verify_psm(int tau, int active_time)
+{
+	if (power_saving_req.tau < 0) {
+		return;
+	}
+
+	if ((tau != power_saving_req.tau) ||
+	    (active_time != power_saving_req.active_time)) {
+		LOG_WRN("PSM granted TAU: %d s, active time: %d s", tau,
+			active_time);
+		LOG_WRN("PSM requested TAU: %d s, active time: %d s",
+			power_saving_req.tau, power_saving_req.active_time);
+	} else {
+		LOG_DBG("PSM granted as requested");
+	}
+}
+
+static void radio_account(int64_t now, uint32_t time)
+{
+	if (now - radio.day_start >= RADIO_DAY_MS) {
+		LOG_INF("RRC connected time in the last 24 hours: %d s",
+			radio.day_time / MSEC_PER_SEC);
+		LOG_INF("Of which without publications: %d s",
+			radio.day_other / MSEC_PER_SEC);
+
+		radio.day_start = now;
+		radio.day_time = 0;
+		radio.day_other = 0;
+	}
+
+	radio.total += time;
+	radio.day_time += time;
+
+	LOG_INF("RRC connected for %d ms, publications: %d, downlinks: %d",
+		time, radio.publishes, radio.downlinks);
+	LOG_INF("Downlink bytes: %d", radio.downlink_bytes);
+
+	/* The cost per publication is only updated by connections that
+	 * carried publications. The time of other connections is reported
+	 * on its own instead of being hidden.
+	 */
+	if (radio.publishes > 0) {
+		radio.cost = time / radio.publishes;
+	} else {
+		radio.day_other += time;
+	}
+
+	LOG_INF("Radio time per publication: %d ms, today: %d s, total: %d s",
+		radio.cost, radio.day_time / MSEC_PER_SEC,
+		(uint32_t)(radio.total / MSEC_PER_SEC));
+	LOG_INF("Radio time without publications today: %d s",
+		radio.day_other / MSEC_PER_SEC);
+
+	radio.publishes = 0;
+	radio.downlinks = 0;
+	radio.downlink_bytes = 0;
+}
+
+static void rrc_connected(void)
+{
+	rrc_stats.connected = k_uptime_get();
+	uplink_done = 0;
+}
+
+static void rrc_idle(void)
+{
+	int64_t now = k_uptime_get();
+	uint32_t time;
+	bool released = IS_ENABLED(CONFIG_CLOUD_RAI) && (uplink_done != 0) &&
+			(now - uplink_done <= RAI_RELEASE_TIME);
+
+	if (rrc_stats.connected == 0) {
+		return;
+	}
+
+	time = now - rrc_stats.connected;
+	rrc_stats.connected = 0;
+
+	radio_account(now, time);
+
+	if (released) {
+		rrc_stats.rai_count++;
+		rrc_stats.rai_time += time;
+	} else {
+		rrc_stats.timer_count++;
+		rrc_stats.timer_time += time;
+	}
+
+	uplink_done = 0;
+
+	LOG_DBG("RRC connected for %d ms, %s", time,
+		released ? "released after RAI" : "released by network");
+
+	if (IS_ENABLED(CONFIG_CLOUD_RAI)) {
+		LOG_DBG("Average RRC time, RAI: %d ms, network: %d ms",
+			rrc_stats.rai_count ?
+			rrc_stats.rai_time / rrc_stats.rai_count : 0,
+			rrc_stats.timer_count ?
+			rrc_stats.timer_time / rrc_stats.timer_count : 0);
+	}
+}
+
 static int lte_connect(void)
 {
 	int err;
@@ -464,6 +986,8 @@ static int modem_data_init(void)
 {
 	int err;
 
+	k_delayed_work_init(&rsrp_update_work, rsrp_update_work_fn);
+
 	err = modem_info_init();
 	if (err) {
 		LOG_INF("modem_info_init, error: %d", err);
@@ -569,25 +1093,46 @@ static void on_all_states(struct modem_msg_data *msg)
 	}
 
 	if (IS_EVENT(msg, app, APP_EVT_DATA_GET)) {
-		if (static_modem_data_requested(msg->module.app.data_list,
-						msg->module.app.count)) {
+		int err = 0;
+		bool swept = false;
+		bool static_changed = false;
+		bool static_requested = static_modem_data_requested(
+						msg->module.app.data_list,
+						msg->module.app.count);
+		bool dynamic_requested = dynamic_modem_data_requested(
+						msg->module.app.data_list,
+						msg->module.app.count);
+
+		memset(&at_stats, 0, sizeof(at_stats));
+
+		if (dynamic_requested ||
+		    (static_requested && !static_cache.valid)) {
+			err = modem_info_sweep();
+			swept = (err == 0);
+		}
 
-			int err;
+		if (swept) {
+			static_changed = static_cache_update();
+		}
 
-			err = static_modem_data_get();
-			if (err) {
+		/* Static modem data is also reported unrequested if a sweep
+		 * shows that it has changed, for instance after a band change.
+		 */
+		if (static_requested) {
+			if (static_cache.valid) {
+				static_modem_data_get();
+			} else {
 				SEND_EVENT(modem,
 					MODEM_EVT_MODEM_STATIC_DATA_NOT_READY);
 			}
+		} else if (static_changed) {
+			static_modem_data_get();
 		}
 
-		if (dynamic_modem_data_requested(msg->module.app.data_list,
-						 msg->module.app.count)) {
-
-			int err;
-
-			err = dynamic_modem_data_get();
-			if (err) {
+		if (dynamic_requested) {
+			if (swept) {
+				dynamic_modem_data_get();
+			} else {
 				SEND_EVENT(modem,
 					MODEM_EVT_MODEM_DYNAMIC_DATA_NOT_READY);
 			}
@@ -595,15 +1140,51 @@ static void on_all_states(struct modem_msg_data *msg)
 
 		if (battery_data_requested(msg->module.app.data_list,
 					   msg->module.app.count)) {
-
-			int err;
-
-			err = battery_data_get();
+			err = battery_data_get(swept);
 			if (err) {
 				SEND_EVENT(modem,
 					MODEM_EVT_BATTERY_DATA_NOT_READY);
 			}
 		}
+
+		LOG_DBG("Modem info sweeps: %d, queries: %d, time: %d ms",
+			at_stats.sweeps, at_stats.queries, at_stats.time);
+	}
+
+	if ((IS_EVENT(msg, data, DATA_EVT_CONFIG_INIT)) ||
+	    (IS_EVENT(msg, data, DATA_EVT_CONFIG_READY))) {
+		if (IS_ENABLED(CONFIG_MODEM_DYNAMIC_POWER_SAVING)) {
+			power_saving_configure(&msg->module.data.data.cfg);
+		}
+	}
+
+	if (IS_EVENT(msg, modem, MODEM_EVT_LTE_RRC_CONNECTED)) {
+		rrc_connected();
+	}
+
+	if (IS_EVENT(msg, modem, MODEM_EVT_LTE_RRC_IDLE)) {
+		rrc_idle();
+	}
+
+	if (IS_EVENT(msg, cloud, CLOUD_EVT_UPLINK_DONE)) {
+		uplink_done = k_uptime_get();
+	}
+
+	if ((IS_EVENT(msg, data, DATA_EVT_DATA_SEND)) ||
+	    (IS_EVENT(msg, data, DATA_EVT_DATA_SEND_BATCH)) ||
+	    (IS_EVENT(msg, data, DATA_EVT_UI_DATA_SEND)) ||
+	    (IS_EVENT(msg, data, DATA_EVT_CONFIG_SEND))) {
+		radio.publishes++;
+	}
+
+	if (IS_EVENT(msg, cloud, CLOUD_EVT_DATA_RECEIVED)) {
+		radio.downlinks++;
+		radio.downlink_bytes += msg->module.cloud.data.len;
+	}
+
+	if (IS_EVENT(msg, modem, MODEM_EVT_LTE_PSM_UPDATE)) {
+		power_saving_verify_psm(msg->module.modem.data.psm.tau,
+					msg->module.modem.data.psm.active_time);
 	}
 
 	if (IS_EVENT(msg, util, UTIL_EVT_SHUTDOWN_REQUEST)) {
@@ -663,4 +1244,5 @@ EVENT_LISTENER(MODULE, event_handler);
 EVENT_SUBSCRIBE_EARLY(MODULE, modem_module_event);
 EVENT_SUBSCRIBE(MODULE, app_module_event);
 EVENT_SUBSCRIBE(MODULE, cloud_module_event);
+EVENT_SUBSCRIBE(MODULE, data_module_event);
 EVENT_SUBSCRIBE_FINAL(MODULE, util_module_event);
@@ -83,3 +83,26 @@ uint32_t module_active_count_get(void)
 {
 	return atomic_get(&active_module_count);
 }
+
+#if defined(CONFIG_MODULES_COMMON_HANDLER_STATS)
+void module_handler_stats_update(struct module_data *module, uint32_t start)
+{
+	uint32_t time_us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+
+	module->handler_count++;
+	module->handler_time_total_us += time_us;
+	module->handler_time_max_us = MAX(module->handler_time_max_us,
+					  time_us);
+
+	if ((module->handler_count %
+	     CONFIG_MODULES_COMMON_HANDLER_STATS_INTERVAL) != 0) {
+		return;
+	}
+
+	LOG_INF("%s module: %d events, handler time avg %d us, max %d us",
+		log_strdup(module->name), module->handler_count,
+		(uint32_t)(module->handler_time_total_us /
+			   module->handler_count),
+		module->handler_time_max_us);
+}
+#endif
@@ -26,6 +26,12 @@ struct module_data {
 	k_tid_t thread_id;
 	char *name;
 	struct k_msgq *msg_q;
+#if defined(CONFIG_MODULES_COMMON_HANDLER_STATS)
+	/* Number of events handled and time spent in the event handler. */
+	uint32_t handler_count;
+	uint32_t handler_time_max_us;
+	uint64_t handler_time_total_us;
+#endif
 };
 
 void module_register(struct module_data *module);
@@ -48,4 +54,23 @@ void module_start(struct module_data *module);
 
 uint32_t module_active_count_get(void);
 
+/** @brief Update the event handler statistics of a module.
+ *
+ *  Time spent in a module's event handler delays the delivery of the event
+ *  to the remaining listeners and of all subsequent events.
+ *
+ *  @param module Pointer to the module.
+ *  @param start Cycle count when the event handler was entered.
+ */
+#if defined(CONFIG_MODULES_COMMON_HANDLER_STATS)
+void module_handler_stats_update(struct module_data *module, uint32_t start);
+#else
+static inline void module_handler_stats_update(struct module_data *module,
+					       uint32_t start)
+{
+	ARG_UNUSED(module);
+	ARG_UNUSED(start);
+}
+#endif
+
 #endif /* _MODULES_COMMON_H_ */
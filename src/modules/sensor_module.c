@@ -6,6 +6,7 @@
 
 #include <zephyr.h>
 #include <stdio.h>
+#include <math.h>
 #include <drivers/sensor.h>
 #include <event_manager.h>
 
@@ -13,6 +14,10 @@
 #include "ext_sensors.h"
 #endif
 
+#if defined(CONFIG_ACTIVITY_CLASSIFIER)
+#include "activity_classifier.h"
+#endif
+
 #define MODULE sensor_module
 
 #include "modules_common.h"
@@ -53,6 +58,33 @@ static struct module_data self = {
 /* Forward declarations. */
 #if defined(CONFIG_EXTERNAL_SENSORS)
 static void movement_data_send(const struct ext_sensor_evt *const acc_data);
+static void inactivity_send(void);
+static bool movement_window_add(const struct ext_sensor_evt *const acc_data);
+static void movement_window_close(void);
+static void movement_window_close_work_fn(struct k_work *work);
+
+/* Set when the accelerometer has reported inactivity after the last
+ * movement. Uptime of the inactivity report is kept in still_since.
+ */
+static bool still;
+static int64_t still_since;
+
+/* Accelerometer triggers are merged into a movement window, which is closed
+ * when no trigger has occurred for the quiet period or when it reaches its
+ * maximum duration. The window is updated from the accelerometer trigger
+ * thread and closed from the system workqueue.
+ */
+static struct movement_window {
+	bool open;
+	int64_t start;
+	int64_t end;
+	uint32_t count;
+	double first[ACCELEROMETER_CHANNELS];
+	double peak[ACCELEROMETER_CHANNELS];
+} window;
+
+static struct k_spinlock window_lock;
+static struct k_delayed_work movement_window_close_work;
 #endif
 
 /* Convenience functions used in internal state handling. */
@@ -87,6 +119,7 @@ static bool event_handler(const struct event_header *eh)
 {
 	struct sensor_msg_data msg = {0};
 	bool enqueue_msg = false;
+	uint32_t start = k_cycle_get_32();
 
 	if (is_app_module_event(eh)) {
 		struct app_module_event *event = cast_app_module_event(eh);
@@ -118,6 +151,8 @@ static bool event_handler(const struct event_header *eh)
 		}
 	}
 
+	module_handler_stats_update(&self, start);
+
 	return false;
 }
 
@@ -126,7 +161,35 @@ static void ext_sensor_handler(const struct ext_sensor_evt *const evt)
 {
 	switch (evt->type) {
 	case EXT_SENSOR_EVT_ACCELEROMETER_TRIGGER:
-		movement_data_send(evt);
+		LOG_DBG("Movement, %d samples in block", evt->sample_count);
+
+#if defined(CONFIG_ACTIVITY_CLASSIFIER)
+		activity_classifier_samples_add(evt->samples, evt->sample_count,
+						k_uptime_get());
+#endif
+		still = false;
+
+		/* Only the first trigger in a window is reported right away,
+		 * the window is reported when it is closed.
+		 */
+		if (movement_window_add(evt)) {
+			movement_data_send(evt);
+		}
+		break;
+	case EXT_SENSOR_EVT_ACCELEROMETER_INACTIVITY:
+		if (still) {
+			break;
+		}
+
+		still = true;
+		still_since = k_uptime_get();
+
+		/* The window is closed before inactivity is reported, so that
+		 * subscribers do not receive movement after inactivity.
+		 */
+		k_delayed_work_cancel(&movement_window_close_work);
+		movement_window_close();
+		inactivity_send();
 		break;
 	default:
 		break;
@@ -149,6 +212,122 @@ static void movement_data_send(const struct ext_sensor_evt *const acc_data)
 
 	EVENT_SUBMIT(sensor_module_event);
 }
+
+static void inactivity_send(void)
+{
+	struct sensor_module_event *sensor_module_event =
+			new_sensor_module_event();
+
+	sensor_module_event->data.inactivity.since = still_since;
+	sensor_module_event->type = SENSOR_EVT_MOVEMENT_INACTIVITY;
+
+	EVENT_SUBMIT(sensor_module_event);
+}
+
+/* Add a trigger to the movement window. Returns true if the trigger opened a
+ * new window.
+ */
+static bool movement_window_add(const struct ext_sensor_evt *const acc_data)
+{
+	bool opened;
+	bool expired;
+	int64_t now = k_uptime_get();
+	k_spinlock_key_t key = k_spin_lock(&window_lock);
+
+	opened = !window.open;
+	if (opened) {
+		window = (struct movement_window) {
+			.open = true,
+			.start = now
+		};
+
+		for (size_t i = 0; i < ACCELEROMETER_CHANNELS; i++) {
+			window.first[i] = acc_data->value_array[i];
+		}
+	}
+
+	window.end = now;
+	window.count++;
+
+	for (size_t i = 0; i < ACCELEROMETER_CHANNELS; i++) {
+		window.peak[i] = MAX(window.peak[i],
+				     fabs(acc_data->value_array[i]));
+	}
+
+	expired = (now - window.start) >=
+		  (CONFIG_SENSOR_MOVEMENT_WINDOW_MAX * MSEC_PER_SEC);
+
+	k_spin_unlock(&window_lock, key);
+
+	if (expired) {
+		k_delayed_work_submit(&movement_window_close_work, K_NO_WAIT);
+	} else {
+		k_delayed_work_submit(&movement_window_close_work,
+			K_SECONDS(CONFIG_SENSOR_MOVEMENT_QUIET_PERIOD));
+	}
+
+	return opened;
+}
+
+static void movement_window_close(void)
+{
+	struct movement_window closed;
+	struct sensor_module_event *sensor_module_event;
+	k_spinlock_key_t key = k_spin_lock(&window_lock);
+
+	closed = window;
+	window.open = false;
+
+	k_spin_unlock(&window_lock, key);
+
+	if (!closed.open) {
+		return;
+	}
+
+	sensor_module_event = new_sensor_module_event();
+	sensor_module_event->data.window.start = closed.start;
+	sensor_module_event->data.window.end = closed.end;
+	sensor_module_event->data.window.count = closed.count;
+	sensor_module_event->data.window.values[0] = closed.first[0];
+	sensor_module_event->data.window.values[1] = closed.first[1];
+	sensor_module_event->data.window.values[2] = closed.first[2];
+	sensor_module_event->data.window.peak[0] = closed.peak[0];
+	sensor_module_event->data.window.peak[1] = closed.peak[1];
+	sensor_module_event->data.window.peak[2] = closed.peak[2];
+	sensor_module_event->type = SENSOR_EVT_MOVEMENT_WINDOW_READY;
+
+	EVENT_SUBMIT(sensor_module_event);
+}
+
+static void movement_window_close_work_fn(struct k_work *work)
+{
+	movement_window_close();
+}
+#endif
+
+#if defined(CONFIG_ACTIVITY_CLASSIFIER)
+static void activity_data_send(void)
+{
+	int err;
+	struct activity_summary summary;
+	struct sensor_module_event *sensor_module_event;
+
+	err = activity_classifier_summary_get(&summary, k_uptime_get());
+	if (err) {
+		LOG_DBG("No activity since last report");
+		return;
+	}
+
+	sensor_module_event = new_sensor_module_event();
+	sensor_module_event->data.activity.timestamp = k_uptime_get();
+	sensor_module_event->data.activity.rest = summary.time[ACTIVITY_REST];
+	sensor_module_event->data.activity.walk = summary.time[ACTIVITY_WALK];
+	sensor_module_event->data.activity.run = summary.time[ACTIVITY_RUN];
+	sensor_module_event->data.activity.jump = summary.time[ACTIVITY_JUMP];
+	sensor_module_event->type = SENSOR_EVT_ACTIVITY_DATA_READY;
+
+	EVENT_SUBMIT(sensor_module_event);
+}
 #endif
 
 static int environmental_data_get(void)
@@ -156,25 +335,19 @@ static int environmental_data_get(void)
 	struct sensor_module_event *sensor_module_event;
 #if defined(CONFIG_EXTERNAL_SENSORS)
 	int err;
-	double temp, hum;
+	struct ext_sensors_env_snapshot snapshot;
 
 	/* Request data from external sensors. */
-	err = ext_sensors_temperature_get(&temp);
+	err = ext_sensors_env_snapshot_get(&snapshot);
 	if (err) {
-		LOG_ERR("temperature_get, error: %d", err);
-		return err;
-	}
-
-	err = ext_sensors_humidity_get(&hum);
-	if (err) {
-		LOG_ERR("temperature_get, error: %d", err);
+		LOG_ERR("ext_sensors_env_snapshot_get, error: %d", err);
 		return err;
 	}
 
 	sensor_module_event = new_sensor_module_event();
 	sensor_module_event->data.sensors.timestamp = k_uptime_get();
-	sensor_module_event->data.sensors.temperature = temp;
-	sensor_module_event->data.sensors.humidity = hum;
+	sensor_module_event->data.sensors.temperature = snapshot.temperature;
+	sensor_module_event->data.sensors.humidity = snapshot.humidity;
 	sensor_module_event->type = SENSOR_EVT_ENVIRONMENTAL_DATA_READY;
 #else
 
@@ -201,6 +374,9 @@ static int setup(void)
 #if defined(CONFIG_EXTERNAL_SENSORS)
 	int err;
 
+	k_delayed_work_init(&movement_window_close_work,
+			    movement_window_close_work_fn);
+
 	err = ext_sensors_init(ext_sensor_handler);
 	if (err) {
 		LOG_ERR("ext_sensors_init, error: %d", err);
@@ -264,6 +440,12 @@ static void on_state_running(struct sensor_msg_data *msg)
 	}
 
 	if (IS_EVENT(msg, app, APP_EVT_DATA_GET)) {
+#if defined(CONFIG_ACTIVITY_CLASSIFIER)
+		/* The activity summary is sent with every sample request,
+		 * ahead of the requested data.
+		 */
+		activity_data_send();
+#endif
 		if (!environmental_data_requested(
 			msg->module.app.data_list,
 			msg->module.app.count)) {
@@ -77,7 +77,7 @@ K_MSGQ_DEFINE(msgq_ui, sizeof(struct ui_msg_data),
 
 static struct module_data self = {
 	.name = "ui",
-	.msg_q = NULL,
+	.msg_q = &msgq_ui,
 };
 
 /* Forward declarations. */
@@ -141,51 +141,56 @@ static void sub_state_set(enum sub_state_type new_state)
 /* Handlers */
 static bool event_handler(const struct event_header *eh)
 {
+	struct ui_msg_data msg = {0};
+	bool enqueue_msg = false;
+	uint32_t start = k_cycle_get_32();
+
 	if (is_app_module_event(eh)) {
 		struct app_module_event *event = cast_app_module_event(eh);
-		struct ui_msg_data ui_msg = {
-			.module.app = *event
-		};
 
-		message_handler(&ui_msg);
+		msg.module.app = *event;
+		enqueue_msg = true;
 	}
 
 	if (is_data_module_event(eh)) {
 		struct data_module_event *event = cast_data_module_event(eh);
-		struct ui_msg_data ui_msg = {
-			.module.data = *event
-		};
 
-		message_handler(&ui_msg);
+		msg.module.data = *event;
+		enqueue_msg = true;
 	}
 
 	if (is_modem_module_event(eh)) {
 		struct modem_module_event *event = cast_modem_module_event(eh);
-		struct ui_msg_data ui_msg = {
-			.module.modem = *event
-		};
 
-		message_handler(&ui_msg);
+		msg.module.modem = *event;
+		enqueue_msg = true;
 	}
 
 	if (is_gps_module_event(eh)) {
 		struct gps_module_event *event = cast_gps_module_event(eh);
-		struct ui_msg_data ui_msg = {
-			.module.gps = *event
-		};
 
-		message_handler(&ui_msg);
+		msg.module.gps = *event;
+		enqueue_msg = true;
 	}
 
 	if (is_util_module_event(eh)) {
 		struct util_module_event *event = cast_util_module_event(eh);
-		struct ui_msg_data ui_msg = {
-			.module.util = *event
-		};
 
-		message_handler(&ui_msg);
+		msg.module.util = *event;
+		enqueue_msg = true;
 	}
 
+	if (enqueue_msg) {
+		int err = module_enqueue_msg(&self, &msg);
+
+		if (err) {
+			LOG_ERR("Message could not be enqueued");
+			SEND_ERROR(ui, UI_EVT_ERROR, err);
+		}
+	}
+
+	module_handler_stats_update(&self, start);
+
 	return false;
 }
 
@@ -426,6 +431,22 @@ static void message_handler(struct ui_msg_data *msg)
 	on_all_states(msg);
 }
 
+static void module_thread_fn(void)
+{
+	struct ui_msg_data msg;
+
+	self.thread_id = k_current_get();
+
+	while (true) {
+		module_get_next_msg(&self, &msg);
+		message_handler(&msg);
+	}
+}
+
+K_THREAD_DEFINE(ui_module_thread, CONFIG_UI_THREAD_STACK_SIZE,
+		module_thread_fn, NULL, NULL, NULL,
+		K_LOWEST_APPLICATION_THREAD_PRIO, 0, 0);
+
 EVENT_LISTENER(MODULE, event_handler);
 EVENT_SUBSCRIBE_EARLY(MODULE, app_module_event);
 EVENT_SUBSCRIBE_EARLY(MODULE, data_module_event);
@@ -82,6 +82,8 @@ static void state_set(enum state_type new_state)
 /* Handlers */
 static bool event_handler(const struct event_header *eh)
 {
+	uint32_t start = k_cycle_get_32();
+
 	if (is_modem_module_event(eh)) {
 		struct modem_module_event *event = cast_modem_module_event(eh);
 		struct util_msg_data util_msg = {
@@ -146,6 +148,8 @@ static bool event_handler(const struct event_header *eh)
 		message_handler(&util_msg);
 	}
 
+	module_handler_stats_update(&self, start);
+
 	return false;
 }
 
@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+#include <zephyr.h>
+#include <math.h>
+#include "position_filter.h"
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(position_filter, CONFIG_POSITION_FILTER_LOG_LEVEL);
+
+#define GRAVITY			9.80665f
+#define METERS_PER_DEGREE	111320.0
+#define DEG_TO_RAD		(3.14159265358979 / 180.0)
+
+/* Process noise, as acceleration standard deviation in m/s2, while the
+ * device moves. The minimum applies when no movement has been reported
+ * recently, reported motion energy is added on top with a decaying weight.
+ */
+#define ACC_NOISE_MIN		0.3f
+#define ACC_NOISE_GAIN		0.5f
+#define MOTION_DECAY_MS		60000
+
+/* Measurement noise of the GPS speed in m/s, and of the zero velocity update
+ * when the device is still.
+ */
+#define SPEED_NOISE		1.0f
+#define STILL_SPEED_NOISE	0.05f
+
+/* Growth of the position variance in m2/s while the device is still. The
+ * device may be carried without the accelerometer reporting it, so the
+ * estimate must not stay confident forever.
+ */
+#define STILL_POSITION_NOISE	0.05f
+
+/* Position and velocity along one horizontal axis with its covariance. */
+struct axis {
+	float p;
+	float v;
+	float p00;
+	float p01;
+	float p11;
+};
+
+static struct filter {
+	bool valid;
+	bool still;
+	/* Reference position. Moved to the estimate on every fix to keep the
+	 * local coordinates small.
+	 */
+	double latitude;
+	double longitude;
+	double cos_latitude;
+	float altitude;
+	int64_t time;
+	/* Uptime of the last fix. */
+	int64_t fix_time;
+	/* Motion energy in m/s2 and the uptime it was reported. */
+	float energy;
+	int64_t energy_time;
+	struct axis north;
+	struct axis east;
+} filter;
+
+static void axis_predict(struct axis *a, float dt, float q)
+{
+	float dt2 = dt * dt;
+
+	a->p += a->v * dt;
+	a->p00 += dt * (2.0f * a->p01 + dt * a->p11) + q * dt2 * dt2 / 4.0f;
+	a->p01 += dt * a->p11 + q * dt2 * dt / 2.0f;
+	a->p11 += q * dt2;
+}
+
+static void axis_position_update(struct axis *a, float z, float r)
+{
+	float s = a->p00 + r;
+	float k0 = a->p00 / s;
+	float k1 = a->p01 / s;
+	float y = z - a->p;
+
+	a->p += k0 * y;
+	a->v += k1 * y;
+	a->p11 -= k1 * a->p01;
+	a->p00 -= k0 * a->p00;
+	a->p01 -= k0 * a->p01;
+}
+
+static void axis_velocity_update(struct axis *a, float z, float r)
+{
+	float s = a->p11 + r;
+	float k0 = a->p01 / s;
+	float k1 = a->p11 / s;
+	float y = z - a->v;
+
+	a->p += k0 * y;
+	a->v += k1 * y;
+	a->p00 -= k0 * a->p01;
+	a->p01 -= k0 * a->p11;
+	a->p11 -= k1 * a->p11;
+}
+
+/* Advance the filter to the given uptime. */
+static void predict(int64_t time)
+{
+	float dt;
+	float sigma;
+	float decay;
+
+	if (time <= filter.time) {
+		return;
+	}
+
+	dt = (time - filter.time) / (float)MSEC_PER_SEC;
+	filter.time = time;
+
+	/* The velocity is known to be zero while still, only the position
+	 * uncertainty grows, as a random walk.
+	 */
+	if (filter.still) {
+		filter.north.p00 += STILL_POSITION_NOISE * dt;
+		filter.east.p00 += STILL_POSITION_NOISE * dt;
+		return;
+	}
+
+	decay = expf(-(float)(time - filter.energy_time) / MOTION_DECAY_MS);
+	sigma = ACC_NOISE_MIN + ACC_NOISE_GAIN * filter.energy * decay;
+
+	axis_predict(&filter.north, dt, sigma * sigma);
+	axis_predict(&filter.east, dt, sigma * sigma);
+}
+
+/* Move the reference position to the current estimate. */
+static void rebase(void)
+{
+	filter.latitude += filter.north.p / METERS_PER_DEGREE;
+	filter.longitude += filter.east.p /
+			    (METERS_PER_DEGREE * filter.cos_latitude);
+	filter.cos_latitude = cos(filter.latitude * DEG_TO_RAD);
+	filter.north.p = 0.0f;
+	filter.east.p = 0.0f;
+}
+
+void position_filter_fix_add(double latitude, double longitude,
+			     float altitude, float accuracy, float speed,
+			     float heading, int64_t time)
+{
+	float r = MAX(accuracy * accuracy, 1.0f);
+	float v_north = speed * cos(heading * DEG_TO_RAD);
+	float v_east = speed * sin(heading * DEG_TO_RAD);
+
+	filter.altitude = altitude;
+	filter.fix_time = time;
+
+	if (!filter.valid) {
+		filter.valid = true;
+		filter.latitude = latitude;
+		filter.longitude = longitude;
+		filter.cos_latitude = cos(latitude * DEG_TO_RAD);
+		filter.time = time;
+		filter.north = (struct axis) {
+			.v = v_north,
+			.p00 = r,
+			.p11 = SPEED_NOISE * SPEED_NOISE
+		};
+		filter.east = (struct axis) {
+			.v = v_east,
+			.p00 = r,
+			.p11 = SPEED_NOISE * SPEED_NOISE
+		};
+		return;
+	}
+
+	predict(time);
+
+	axis_position_update(&filter.north,
+			     (latitude - filter.latitude) * METERS_PER_DEGREE,
+			     r);
+	axis_position_update(&filter.east,
+			     (longitude - filter.longitude) *
+			     METERS_PER_DEGREE * filter.cos_latitude,
+			     r);
+
+	/* The GPS velocity is not used while the device is known to be still,
+	 * as the speed of a stationary receiver is mostly noise.
+	 */
+	if (!filter.still) {
+		axis_velocity_update(&filter.north, v_north,
+				     SPEED_NOISE * SPEED_NOISE);
+		axis_velocity_update(&filter.east, v_east,
+				     SPEED_NOISE * SPEED_NOISE);
+	}
+
+	rebase();
+
+	LOG_DBG("Fix added, uncertainty: %d m",
+		(int)sqrtf(MAX(filter.north.p00, filter.east.p00)));
+}
+
+void position_filter_motion_add(const double values[3], int64_t time)
+{
+	float magnitude = sqrt(values[0] * values[0] +
+			       values[1] * values[1] +
+			       values[2] * values[2]);
+	float decay;
+
+	predict(time);
+
+	decay = expf(-(float)(time - filter.energy_time) / MOTION_DECAY_MS);
+
+	filter.energy = MAX(filter.energy * decay, fabsf(magnitude - GRAVITY));
+	filter.energy_time = time;
+	filter.still = false;
+}
+
+void position_filter_still(int64_t time)
+{
+	if (!filter.valid) {
+		filter.still = true;
+		return;
+	}
+
+	predict(time);
+
+	axis_velocity_update(&filter.north, 0.0f,
+			     STILL_SPEED_NOISE * STILL_SPEED_NOISE);
+	axis_velocity_update(&filter.east, 0.0f,
+			     STILL_SPEED_NOISE * STILL_SPEED_NOISE);
+
+	filter.still = true;
+	filter.energy = 0.0f;
+}
+
+int position_filter_estimate_get(int64_t time,
+				 struct position_filter_estimate *estimate)
+{
+	float heading;
+
+	if (!filter.valid) {
+		return -ENODATA;
+	}
+
+	predict(time);
+
+	heading = atan2f(filter.east.v, filter.north.v) / DEG_TO_RAD;
+
+	estimate->latitude = filter.latitude +
+			     filter.north.p / METERS_PER_DEGREE;
+	estimate->longitude = filter.longitude + filter.east.p /
+			      (METERS_PER_DEGREE * filter.cos_latitude);
+	estimate->altitude = filter.altitude;
+	estimate->fix_time = filter.fix_time;
+	estimate->uncertainty = sqrtf(MAX(filter.north.p00, filter.east.p00));
+	estimate->speed = sqrtf(filter.north.v * filter.north.v +
+				filter.east.v * filter.east.v);
+	estimate->heading = heading < 0.0f ? heading + 360.0f : heading;
+
+	return 0;
+}
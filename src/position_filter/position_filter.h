@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+/**@file
+ *@brief Position filter library header.
+ */
+
+#ifndef POSITION_FILTER_H__
+#define POSITION_FILTER_H__
+
+#include <zephyr.h>
+
+/**@file
+ *
+ * @defgroup position_filter Position filter
+ * @brief    Module that estimates the position between GPS fixes.
+ * @{
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Position estimate. */
+struct position_filter_estimate {
+	double latitude;
+	double longitude;
+	/** Altitude of the last fix in meters. */
+	float altitude;
+	/** Horizontal 1-sigma uncertainty in meters. */
+	float uncertainty;
+	/** Estimated horizontal speed in m/s. */
+	float speed;
+	/** Estimated heading in degrees. */
+	float heading;
+	/** Uptime of the last fix in milliseconds. */
+	int64_t fix_time;
+};
+
+/**
+ * @brief Add a GPS fix to the filter.
+ *
+ * @param[in] latitude Latitude in degrees.
+ * @param[in] longitude Longitude in degrees.
+ * @param[in] altitude Altitude in meters.
+ * @param[in] accuracy Horizontal accuracy in meters.
+ * @param[in] speed Horizontal speed in m/s.
+ * @param[in] heading Heading in degrees.
+ * @param[in] time Uptime of the fix in milliseconds.
+ */
+void position_filter_fix_add(double latitude, double longitude,
+			     float altitude, float accuracy, float speed,
+			     float heading, int64_t time);
+
+/**
+ * @brief Add accelerometer data reported as movement.
+ *
+ * @param[in] values Acceleration in m/s2 for the X, Y and Z axes.
+ * @param[in] time Uptime of the readings in milliseconds.
+ */
+void position_filter_motion_add(const double values[3], int64_t time);
+
+/**
+ * @brief Report that the device is still. The estimated velocity is reset
+ *	  and the uncertainty grows slowly until movement is reported.
+ *
+ * @param[in] time Uptime since when the device has been still, in
+ *		   milliseconds.
+ */
+void position_filter_still(int64_t time);
+
+/**
+ * @brief Get the estimated position.
+ *
+ * @param[in] time Uptime in milliseconds to estimate the position at.
+ * @param[out] estimate Estimated position.
+ *
+ * @return 0 on success, -ENODATA if no fix has been added.
+ */
+int position_filter_estimate_get(int64_t time,
+				 struct position_filter_estimate *estimate);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @}
+ */
+
+#endif /* POSITION_FILTER_H__ */
@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+#include <zephyr.h>
+#include "qos_list.h"
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(qos_list, CONFIG_QOS_LIST_LOG_LEVEL);
+
+static uint16_t message_id_get(struct qos_list *list)
+{
+	/* Message ID 0 is not allowed for QoS 1 publications. */
+	list->message_id_next++;
+	if (list->message_id_next == 0) {
+		list->message_id_next = 1;
+	}
+
+	return list->message_id_next;
+}
+
+static void stats_log(const struct qos_list *list)
+{
+	LOG_DBG("QoS 1: added %u, acked %u, dropped %u, retransmissions %u",
+		list->stats.added, list->stats.acked, list->stats.dropped,
+		list->stats.retransmissions);
+	LOG_DBG("QoS 1: %u bytes acked, %zu messages pending",
+		list->stats.acked_bytes, list->count);
+}
+
+static void msg_remove(struct qos_list *list, size_t index)
+{
+	list->count--;
+
+	memmove(&list->msgs[index], &list->msgs[index + 1],
+		(list->count - index) * sizeof(list->msgs[0]));
+}
+
+void qos_list_init(struct qos_list *list, struct qos_list_msg *msgs,
+		   size_t size, size_t window, qos_list_send_t send,
+		   qos_list_ack_t ack)
+{
+	*list = (struct qos_list) {
+		.msgs = msgs,
+		.size = size,
+		.window = window,
+		.send = send,
+		.ack = ack
+	};
+}
+
+int qos_list_add(struct qos_list *list, int type, char *buf, size_t len)
+{
+	if (list->count == list->size) {
+		list->stats.dropped++;
+		stats_log(list);
+		return -ENOMEM;
+	}
+
+	list->msgs[list->count++] = (struct qos_list_msg) {
+		.type = type,
+		.buf = buf,
+		.len = len,
+		.timestamp = k_uptime_get()
+	};
+
+	list->stats.added++;
+
+	return 0;
+}
+
+void qos_list_process(struct qos_list *list)
+{
+	size_t in_flight = 0;
+
+	for (size_t i = 0; i < list->count; i++) {
+		int err;
+		struct qos_list_msg *msg = &list->msgs[i];
+
+		if (msg->message_id != 0) {
+			in_flight++;
+			continue;
+		}
+
+		if (in_flight >= list->window) {
+			break;
+		}
+
+		msg->message_id = message_id_get(list);
+
+		err = list->send(msg->type, msg->buf, msg->len,
+				 msg->message_id, i == list->count - 1);
+		if (err) {
+			/* Retried on the next PUBACK, publication or after
+			 * a reconnection.
+			 */
+			msg->message_id = 0;
+			break;
+		}
+
+		if (msg->attempts > 0) {
+			list->stats.retransmissions++;
+		}
+
+		msg->attempts++;
+		in_flight++;
+	}
+}
+
+int qos_list_ack(struct qos_list *list, uint16_t message_id)
+{
+	for (size_t i = 0; i < list->count; i++) {
+		struct qos_list_msg *msg = &list->msgs[i];
+
+		if (msg->message_id != message_id) {
+			continue;
+		}
+
+		LOG_DBG("Message ID %d acked after %lld ms, attempts: %d",
+			message_id, k_uptime_get() - msg->timestamp,
+			msg->attempts);
+
+		list->stats.acked++;
+		list->stats.acked_bytes += msg->len;
+
+		list->ack(msg->buf);
+		msg_remove(list, i);
+		stats_log(list);
+		qos_list_process(list);
+
+		return 0;
+	}
+
+	LOG_DBG("PUBACK for unknown message ID: %d", message_id);
+
+	return -ENOENT;
+}
+
+void qos_list_reset(struct qos_list *list)
+{
+	for (size_t i = 0; i < list->count; i++) {
+		list->msgs[i].message_id = 0;
+	}
+}
+
+size_t qos_list_count(const struct qos_list *list)
+{
+	return list->count;
+}
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+/**@file
+ *@brief QoS 1 list library header.
+ */
+
+#ifndef QOS_LIST_H__
+#define QOS_LIST_H__
+
+#include <zephyr.h>
+
+/**@file
+ *
+ * @defgroup qos_list QoS 1 list
+ * @brief    Module that keeps MQTT QoS 1 messages until they are
+ *	     acknowledged.
+ * @{
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Transmit a message.
+ *
+ * @param[in] type Message type given to qos_list_add().
+ * @param[in] buf Message payload.
+ * @param[in] len Length of the payload.
+ * @param[in] message_id MQTT message ID of the transmission.
+ * @param[in] last True if no other message is waiting to be transmitted.
+ *
+ * @return 0 on success or negative error value on failure.
+ */
+typedef int (*qos_list_send_t)(int type, char *buf, size_t len,
+			       uint16_t message_id, bool last);
+
+/**
+ * @brief Release the payload of a message that has been acknowledged.
+ *
+ * @param[in] buf Message payload.
+ */
+typedef void (*qos_list_ack_t)(void *buf);
+
+/** @brief Message that has not been acknowledged. */
+struct qos_list_msg {
+	int type;
+	char *buf;
+	size_t len;
+	/** Message ID of the latest transmission, 0 if not transmitted. */
+	uint16_t message_id;
+	/** Number of times the message has been transmitted. */
+	uint8_t attempts;
+	/** Uptime when the message was added. */
+	int64_t timestamp;
+};
+
+/** @brief Statistics. The delivery ratio is given by acked / added. */
+struct qos_list_stats {
+	uint32_t added;
+	uint32_t acked;
+	uint32_t dropped;
+	uint32_t retransmissions;
+	uint32_t acked_bytes;
+};
+
+/** @brief List of messages in publication order. */
+struct qos_list {
+	struct qos_list_msg *msgs;
+	size_t size;
+	size_t count;
+	/** Maximum number of messages waiting for a PUBACK. */
+	size_t window;
+	uint16_t message_id_next;
+	qos_list_send_t send;
+	qos_list_ack_t ack;
+	struct qos_list_stats stats;
+};
+
+/**
+ * @brief Initialize a list.
+ *
+ * @param[out] list List to initialize.
+ * @param[in] msgs Storage for the messages of the list.
+ * @param[in] size Number of entries in msgs.
+ * @param[in] window Maximum number of messages waiting for a PUBACK.
+ * @param[in] send Callback that transmits a message.
+ * @param[in] ack Callback that releases an acknowledged message.
+ */
+void qos_list_init(struct qos_list *list, struct qos_list_msg *msgs,
+		   size_t size, size_t window, qos_list_send_t send,
+		   qos_list_ack_t ack);
+
+/**
+ * @brief Add a message to the end of the list. The message is not
+ *	  transmitted until qos_list_process() is called.
+ *
+ * @param[in] list List.
+ * @param[in] type Message type passed to the send callback.
+ * @param[in] buf Message payload.
+ * @param[in] len Length of the payload.
+ *
+ * @return 0 on success, -ENOMEM if the list is full.
+ */
+int qos_list_add(struct qos_list *list, int type, char *buf, size_t len);
+
+/**
+ * @brief Transmit messages as long as the number of messages waiting for a
+ *	  PUBACK is within the window. Transmission stops at the first
+ *	  message that fails to be sent.
+ *
+ * @param[in] list List.
+ */
+void qos_list_process(struct qos_list *list);
+
+/**
+ * @brief Acknowledge the message with the given message ID. The message is
+ *	  released with the ack callback, removed from the list and the next
+ *	  messages are transmitted.
+ *
+ * @param[in] list List.
+ * @param[in] message_id MQTT message ID of the PUBACK.
+ *
+ * @return 0 on success, -ENOENT if no message has the message ID.
+ */
+int qos_list_ack(struct qos_list *list, uint16_t message_id);
+
+/**
+ * @brief Mark all messages as not transmitted. Call this when the
+ *	  connection is lost, unacknowledged messages are transmitted again
+ *	  by the next call to qos_list_process().
+ *
+ * @param[in] list List.
+ */
+void qos_list_reset(struct qos_list *list);
+
+/**
+ * @brief Get the number of messages in the list.
+ *
+ * @param[in] list List.
+ *
+ * @return Number of messages that have not been acknowledged.
+ */
+size_t qos_list_count(const struct qos_list *list);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @}
+ */
+
+#endif /* QOS_LIST_H__ */
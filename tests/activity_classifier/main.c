@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+/* Replays recorded accelerometer traces through the activity classifier and
+ * checks the class of every window against the activity of the trace. With
+ * --bench the time spent computing features and classifying a window is
+ * measured instead.
+ *
+ * Usage: activity_classifier <trace.csv>...
+ *	  activity_classifier --bench <trace.csv>...
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/* The library is included to reach the window functions for the
+ * benchmark.
+ */
+#include "activity_classifier.c"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CYCLES_GET() __rdtsc()
+#else
+#define CYCLES_GET() 0
+#endif
+
+/* Share of the windows of a trace that must be classified as its
+ * activity.
+ */
+#define ACCURACY_MIN		0.9
+
+#define TRACE_SAMPLES_MAX	4096
+#define BENCH_ROUNDS		20000
+
+static double samples[TRACE_SAMPLES_MAX][3];
+
+static int trace_read(const char *name, enum activity_class *label)
+{
+	FILE *file = fopen(name, "r");
+	char line[128];
+	int count = 0;
+
+	if (file == NULL) {
+		perror(name);
+		return -1;
+	}
+
+	*label = ACTIVITY_COUNT;
+
+	while (fgets(line, sizeof(line), file) &&
+	       (count < TRACE_SAMPLES_MAX)) {
+		if (line[0] == '#') {
+			for (int i = 0; i < ACTIVITY_COUNT; i++) {
+				if (strstr(line, class2str(i))) {
+					*label = i;
+				}
+			}
+		} else if (sscanf(line, "%lf,%lf,%lf", &samples[count][0],
+				  &samples[count][1],
+				  &samples[count][2]) == 3) {
+			count++;
+		}
+	}
+
+	fclose(file);
+
+	if (*label == ACTIVITY_COUNT) {
+		fprintf(stderr, "%s: activity not named\n", name);
+		return -1;
+	}
+
+	return count;
+}
+
+/* Classify each window of the trace through the library API, the summary
+ * of a single window holds its class.
+ */
+static int trace_check(const char *name, int64_t *time)
+{
+	struct activity_summary summary;
+	enum activity_class label;
+	int windows;
+	int count[ACTIVITY_COUNT] = { 0 };
+	int samples_count = trace_read(name, &label);
+
+	if (samples_count < 0) {
+		return -1;
+	}
+
+	windows = samples_count / WINDOW_SAMPLES;
+
+	for (int i = 0; i < windows; i++) {
+		*time += WINDOW_DURATION_MS;
+
+		activity_classifier_samples_add(&samples[i * WINDOW_SAMPLES],
+						WINDOW_SAMPLES, *time);
+		activity_classifier_summary_get(&summary, *time);
+
+		for (int j = 0; j < ACTIVITY_COUNT; j++) {
+			if (summary.time[j] > 0) {
+				count[j]++;
+				break;
+			}
+		}
+	}
+
+	printf("%s: %d windows, rest %d, walk %d, run %d, jump %d: %s\n",
+	       name, windows, count[ACTIVITY_REST], count[ACTIVITY_WALK],
+	       count[ACTIVITY_RUN], count[ACTIVITY_JUMP],
+	       (count[label] >= ACCURACY_MIN * windows) ? "PASS" : "FAIL");
+
+	return (count[label] >= ACCURACY_MIN * windows) ? 0 : -1;
+}
+
+/* Measure features_compute() and classify() on every window of the traces,
+ * the input conversion in activity_classifier_samples_add() is excluded.
+ */
+static int bench(int traces, char **names)
+{
+	static uint16_t mag[TRACE_SAMPLES_MAX];
+	struct activity_features features;
+	enum activity_class label;
+	volatile int sink = 0;
+	int windows = 0;
+	uint64_t cycles;
+	uint32_t start;
+	uint32_t ns;
+
+	for (int i = 0; i < traces; i++) {
+		int count = trace_read(names[i], &label);
+
+		if (count < 0) {
+			return -1;
+		}
+
+		count -= count % WINDOW_SAMPLES;
+
+		for (int j = 0; (j < count) &&
+				(windows * WINDOW_SAMPLES + j <
+				 TRACE_SAMPLES_MAX); j++) {
+			int32_t x = samples[j][0] * MG_PER_M_S2;
+			int32_t y = samples[j][1] * MG_PER_M_S2;
+			int32_t z = samples[j][2] * MG_PER_M_S2;
+
+			mag[windows * WINDOW_SAMPLES + j] =
+				isqrt(x * x + y * y + z * z);
+		}
+
+		windows += MIN(count, TRACE_SAMPLES_MAX -
+			       windows * WINDOW_SAMPLES) / WINDOW_SAMPLES;
+	}
+
+	if (windows == 0) {
+		return -1;
+	}
+
+	start = k_cycle_get_32();
+	cycles = CYCLES_GET();
+
+	for (int round = 0; round < BENCH_ROUNDS; round++) {
+		for (int i = 0; i < windows; i++) {
+			features_compute(&mag[i * WINDOW_SAMPLES],
+					 WINDOW_SAMPLES, &features);
+			sink += classify(&features);
+		}
+	}
+
+	cycles = CYCLES_GET() - cycles;
+	ns = k_cycle_get_32() - start;
+
+	printf("%d samples per window: %.0f ns, %.0f TSC cycles per window\n",
+	       WINDOW_SAMPLES, (double)ns / BENCH_ROUNDS / windows,
+	       (double)cycles / BENCH_ROUNDS / windows);
+
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	int64_t time = 0;
+	int failures = 0;
+
+	if ((argc > 1) && (strcmp(argv[1], "--bench") == 0)) {
+		return bench(argc - 2, &argv[2]) ? EXIT_FAILURE : EXIT_SUCCESS;
+	}
+
+	if (argc < 2) {
+		fprintf(stderr, "Usage: %s [--bench] <trace.csv>...\n",
+			argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	for (int i = 1; i < argc; i++) {
+		failures += trace_check(argv[i], &time) ? 1 : 0;
+	}
+
+	return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
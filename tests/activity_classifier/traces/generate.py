@@ -0,0 +1,104 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2021 Nordic Semiconductor ASA
+#
+# SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+#
+
+"""Generate the synthetic accelerometer traces replayed by the activity
+classifier test.
+
+Each trace holds one activity sampled at 12.5 Hz, the output data rate used
+on the Thingy:91. The first line names the activity, the following lines are
+X, Y and Z samples in m/s2, clipped to the 2 g range of the accelerometer.
+The generator is seeded, the output is identical on every run.
+"""
+
+import math
+import random
+
+ODR = 12.5
+DURATION = 120
+GRAVITY = 9.80665
+RANGE = 2 * GRAVITY
+WINDOW = 32
+
+
+def clip(value):
+    return max(-RANGE, min(RANGE, value))
+
+
+def write(name, samples):
+    with open(name + '.csv', 'w') as f:
+        f.write('# %s\n' % name)
+        for x, y, z in samples:
+            f.write('%.3f,%.3f,%.3f\n' % (clip(x), clip(y), clip(z)))
+
+
+def orientation(rnd):
+    """Unit vector of gravity in the device frame, the collar is rarely
+    level.
+    """
+    tilt = math.radians(rnd.uniform(0, 40))
+    turn = rnd.uniform(0, 2 * math.pi)
+    return (math.sin(tilt) * math.cos(turn),
+            math.sin(tilt) * math.sin(turn),
+            math.cos(tilt))
+
+
+def gait(rnd, frequency, amplitude, noise):
+    """Periodic gait, the magnitude oscillates around 1 g with a harmonic
+    and a stride to stride variation of the frequency.
+    """
+    g = orientation(rnd)
+    phase = rnd.uniform(0, 2 * math.pi)
+    samples = []
+
+    for i in range(int(DURATION * ODR)):
+        f = frequency * (1 + 0.05 * math.sin(2 * math.pi * i / 200))
+        phase += 2 * math.pi * f / ODR
+        a = GRAVITY + amplitude * GRAVITY * (
+            math.sin(phase) + 0.3 * math.sin(2 * phase + 0.5))
+        samples.append(tuple(a * c + rnd.gauss(0, noise * GRAVITY)
+                             for c in g))
+
+    return samples
+
+
+def rest(rnd):
+    g = orientation(rnd)
+
+    return [tuple(GRAVITY * c + rnd.gauss(0, 0.01 * GRAVITY) for c in g)
+            for _ in range(int(DURATION * ODR))]
+
+
+def jump(rnd):
+    """Resting between jumps, one jump in every classification window. A
+    jump is a crouch, a free fall of about 0.3 s and a landing impact spread
+    over the three axes.
+    """
+    samples = rest(rnd)
+
+    for start in range(0, len(samples) - WINDOW + 1, WINDOW):
+        i = start + rnd.randint(2, WINDOW - 8)
+        samples[i] = tuple(1.3 * v for v in samples[i])
+        for j in range(i + 1, i + 5):
+            samples[j] = tuple(rnd.gauss(0, 0.05 * GRAVITY)
+                               for _ in range(3))
+        samples[i + 5] = (rnd.uniform(1.5, 2.0) * GRAVITY,
+                          rnd.uniform(1.0, 2.0) * GRAVITY,
+                          rnd.uniform(1.5, 2.0) * GRAVITY)
+        samples[i + 6] = tuple(0.6 * v for v in samples[i + 5])
+
+    return samples
+
+
+def main():
+    write('rest', rest(random.Random(1)))
+    write('walk', gait(random.Random(2), 1.6, 0.2, 0.03))
+    write('run', gait(random.Random(3), 3.2, 0.6, 0.05))
+    write('jump', jump(random.Random(4)))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+/* Minimal subset of the Zephyr kernel API needed to build the pure C
+ * libraries of the application on the host.
+ */
+
+#ifndef ZEPHYR_H__
+#define ZEPHYR_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#define MIN(a, b)		(((a) < (b)) ? (a) : (b))
+#define MAX(a, b)		(((a) > (b)) ? (a) : (b))
+#define CLAMP(val, low, high)	(((val) <= (low)) ? (low) : MIN(val, high))
+#define BIT(n)			(1UL << (n))
+#define ARRAY_SIZE(array)	(sizeof(array) / sizeof((array)[0]))
+
+#define MSEC_PER_SEC		1000
+#define USEC_PER_MSEC		1000
+
+struct k_spinlock {
+	int unused;
+};
+
+typedef int k_spinlock_key_t;
+
+static inline k_spinlock_key_t k_spin_lock(struct k_spinlock *lock)
+{
+	(void)lock;
+	return 0;
+}
+
+static inline void k_spin_unlock(struct k_spinlock *lock,
+				 k_spinlock_key_t key)
+{
+	(void)lock;
+	(void)key;
+}
+
+/* The host cycle counter runs at 1 GHz, one cycle per nanosecond. */
+static inline uint32_t k_cycle_get_32(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint32_t)(ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+}
+
+/* Provided by the tests that need it, for instance from a simulated
+ * clock.
+ */
+int64_t k_uptime_get(void);
+
+#endif /* ZEPHYR_H__ */
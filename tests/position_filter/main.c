@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+/* Replays a recorded track through the position filter and checks the
+ * estimates against the true positions of the track.
+ *
+ * Usage: position_filter <track.csv>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "position_filter.h"
+
+#define METERS_PER_DEGREE	111320.0
+#define DEG_TO_RAD		(3.14159265358979 / 180.0)
+
+/* Share of the true positions that must be within three times the
+ * estimated uncertainty.
+ */
+#define COVERAGE_MIN		0.9
+
+static double distance(double lat1, double lon1, double lat2, double lon2)
+{
+	double north = (lat2 - lat1) * METERS_PER_DEGREE;
+	double east = (lon2 - lon1) * METERS_PER_DEGREE *
+		      cos(lat1 * DEG_TO_RAD);
+
+	return sqrt(north * north + east * east);
+}
+
+int main(int argc, char **argv)
+{
+	FILE *file;
+	char line[256];
+	struct position_filter_estimate estimate;
+	int64_t fix_time = 0;
+	bool still = false;
+	float still_uncertainty = 0.0f;
+	int truths = 0;
+	int covered = 0;
+	int failures = 0;
+	double error_sum = 0.0;
+	double error_max = 0.0;
+	double uncertainty_sum = 0.0;
+	float uncertainty_max = 0.0f;
+	int64_t age_max = 0;
+
+	if (argc != 2) {
+		fprintf(stderr, "Usage: %s <track.csv>\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	file = fopen(argv[1], "r");
+	if (file == NULL) {
+		perror(argv[1]);
+		return EXIT_FAILURE;
+	}
+
+	if (position_filter_estimate_get(0, &estimate) != -ENODATA) {
+		printf("Estimate served before the first fix\n");
+		failures++;
+	}
+
+	while (fgets(line, sizeof(line), file)) {
+		long long t;
+		char type[16];
+		double a[6];
+		int64_t time;
+
+		if (sscanf(line, "%lld,%15[a-z]", &t, type) != 2) {
+			continue;
+		}
+
+		time = t;
+
+		if (strcmp(type, "fix") == 0) {
+			sscanf(line, "%*d,fix,%lf,%lf,%lf,%lf,%lf,%lf",
+			       &a[0], &a[1], &a[2], &a[3], &a[4], &a[5]);
+			position_filter_fix_add(a[0], a[1], a[2], a[3], a[4],
+						a[5], time);
+			fix_time = time;
+			still = false;
+		} else if (strcmp(type, "motion") == 0) {
+			sscanf(line, "%*d,motion,%lf,%lf,%lf",
+			       &a[0], &a[1], &a[2]);
+			position_filter_motion_add(a, time);
+			still = false;
+		} else if (strcmp(type, "still") == 0) {
+			position_filter_still(time);
+			position_filter_estimate_get(time, &estimate);
+			still = true;
+			still_uncertainty = estimate.uncertainty;
+		} else if (strcmp(type, "truth") == 0) {
+			double error;
+
+			sscanf(line, "%*d,truth,%lf,%lf", &a[0], &a[1]);
+
+			if (position_filter_estimate_get(time, &estimate)) {
+				continue;
+			}
+
+			error = distance(estimate.latitude,
+					 estimate.longitude, a[0], a[1]);
+
+			truths++;
+			covered += error <= 3.0 * estimate.uncertainty;
+			error_sum += error * error;
+			error_max = MAX(error_max, error);
+			uncertainty_sum += estimate.uncertainty;
+			uncertainty_max = MAX(uncertainty_max,
+					      estimate.uncertainty);
+			age_max = MAX(age_max, time - estimate.fix_time);
+
+			if (estimate.fix_time != fix_time) {
+				printf("%lld: fix time %lld, expected %lld\n",
+				       t, (long long)estimate.fix_time,
+				       (long long)fix_time);
+				failures++;
+			}
+
+			/* The uncertainty must keep growing while still. */
+			if (still) {
+				if (estimate.uncertainty <= still_uncertainty) {
+					printf("%lld: uncertainty %.2f m did "
+					       "not grow while still\n",
+					       t, estimate.uncertainty);
+					failures++;
+				}
+
+				still_uncertainty = estimate.uncertainty;
+			}
+		}
+	}
+
+	fclose(file);
+
+	if (truths == 0) {
+		printf("%s: no estimates\n", argv[1]);
+		return EXIT_FAILURE;
+	}
+
+	if (covered < COVERAGE_MIN * truths) {
+		failures++;
+	}
+
+	printf("%s: %d estimates, %.1f %% within 3 sigma\n", argv[1], truths,
+	       100.0 * covered / truths);
+	printf("  error rms %.1f m, max %.1f m\n", sqrt(error_sum / truths),
+	       error_max);
+	printf("  uncertainty mean %.1f m, max %.1f m\n",
+	       uncertainty_sum / truths, uncertainty_max);
+	printf("  max age of last fix %lld s\n",
+	       (long long)age_max / MSEC_PER_SEC);
+	printf("%s\n", failures ? "FAIL" : "PASS");
+
+	return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
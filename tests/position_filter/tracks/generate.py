@@ -0,0 +1,110 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2021 Nordic Semiconductor ASA
+#
+# SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+#
+
+"""Generate the synthetic tracks replayed by the position filter test.
+
+Each line of a track is an event at an uptime in milliseconds:
+
+  <ms>,fix,<lat>,<lon>,<alt>,<accuracy>,<speed>,<heading>
+  <ms>,motion,<x>,<y>,<z>
+  <ms>,still
+  <ms>,truth,<lat>,<lon>
+
+Fixes carry Gaussian noise with the reported accuracy as standard deviation,
+truth lines are the noise free position that the estimate is checked against.
+The generator is seeded, the output is identical on every run.
+"""
+
+import math
+import random
+
+METERS_PER_DEGREE = 111320.0
+GRAVITY = 9.80665
+
+
+class Track:
+    def __init__(self, name, seed):
+        self.name = name
+        self.rnd = random.Random(seed)
+        self.lat = 63.4305
+        self.lon = 10.3951
+        self.speed = 0.0
+        self.heading = 0.0
+        self.lines = []
+
+    def step(self, dt):
+        north = self.speed * math.cos(math.radians(self.heading)) * dt
+        east = self.speed * math.sin(math.radians(self.heading)) * dt
+        self.lat += north / METERS_PER_DEGREE
+        self.lon += east / (METERS_PER_DEGREE *
+                            math.cos(math.radians(self.lat)))
+
+    def fix(self, t):
+        accuracy = self.rnd.uniform(4.0, 10.0)
+        lat = self.lat + self.rnd.gauss(0, accuracy) / METERS_PER_DEGREE
+        lon = self.lon + self.rnd.gauss(0, accuracy) / (
+            METERS_PER_DEGREE * math.cos(math.radians(self.lat)))
+        speed = max(0.0, self.speed + self.rnd.gauss(0, 0.3))
+        heading = (self.heading + self.rnd.gauss(0, 10.0)) % 360.0
+        self.lines.append('%d,fix,%.7f,%.7f,%.1f,%.1f,%.2f,%.1f' %
+                          (t, lat, lon, 40.0, accuracy, speed, heading))
+
+    def motion(self, t):
+        magnitude = GRAVITY + self.rnd.uniform(1.0, 4.0)
+        self.lines.append('%d,motion,%.3f,%.3f,%.3f' %
+                          (t, 0.0, 0.0, magnitude))
+
+    def still(self, t):
+        self.lines.append('%d,still' % t)
+
+    def truth(self, t):
+        self.lines.append('%d,truth,%.7f,%.7f' % (t, self.lat, self.lon))
+
+    def walk(self, start, duration, fix_interval):
+        """Walk with a slowly wandering heading, one step per second."""
+        for s in range(duration):
+            t = (start + s) * 1000
+            self.speed = min(2.0, max(0.3, self.speed +
+                                      self.rnd.gauss(0, 0.1)))
+            self.heading = (self.heading + self.rnd.gauss(0, 5.0)) % 360.0
+            self.step(1.0)
+            if s % 5 == 0:
+                self.motion(t)
+            if s % fix_interval == 0:
+                self.fix(t)
+            elif s % 10 == 0:
+                self.truth(t)
+
+    def rest(self, start, duration, truth_interval):
+        self.speed = 0.0
+        self.still(start * 1000)
+        for s in range(truth_interval, duration, truth_interval):
+            self.truth((start + s) * 1000)
+
+    def write(self):
+        with open(self.name, 'w') as f:
+            f.write('\n'.join(self.lines) + '\n')
+
+
+def main():
+    # Continuous walk with a fix every two minutes.
+    walk = Track('walk.csv', 1)
+    walk.speed = 1.0
+    walk.walk(0, 1800, 120)
+    walk.write()
+
+    # A short walk, twelve hours of rest without fixes and another walk.
+    dwell = Track('dwell.csv', 2)
+    dwell.speed = 1.0
+    dwell.walk(0, 600, 60)
+    dwell.rest(600, 12 * 3600, 600)
+    dwell.walk(600 + 12 * 3600, 300, 60)
+    dwell.write()
+
+
+if __name__ == '__main__':
+    main()
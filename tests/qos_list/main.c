@@ -0,0 +1,498 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-BSD-5-Clause-Nordic
+ */
+
+/* Publishes messages through the QoS 1 list to a simulated broker over a
+ * link that breaks while a publication is being transmitted with a given
+ * probability. Messages in flight when the link breaks are lost, as are
+ * PUBACKs of messages that have reached the broker. The link comes back
+ * after a reconnection delay.
+ *
+ * For each loss rate and window size the delivered ratio, duplicates and
+ * latency of a day of periodic traffic are reported, followed by the
+ * throughput of a burst that fills the list. QoS 0, where a message is
+ * acknowledged to the Data module as soon as it has been handed to the
+ * link, is given for comparison.
+ *
+ * The test fails if a message is acknowledged before it has reached the
+ * broker, if QoS 1 does not deliver every message or if the statistics of
+ * the list do not add up.
+ *
+ * Usage: qos_list
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "qos_list.h"
+
+/* Number of entries in the list, DATA_PENDING_MAX in the application. */
+#define LIST_SIZE		10
+
+/* LTE-M uplink rate in bytes per millisecond, 25 kbit/s. */
+#define LINK_RATE		3.125
+#define LINK_RTT_MS		400
+#define RECONNECT_DELAY_MS	5000
+
+/* A sample cycle publishes data, batch and UI messages. */
+#define CYCLE_MS		60000
+#define CYCLES			1440
+#define DRAIN_MS		600000
+
+#define BURST_LEN		1000
+#define BURST_RUNS		500
+
+#define MSGS_MAX		(CYCLES * 3 + LIST_SIZE)
+#define EVENTS_MAX		256
+
+static const size_t cycle_len[] = { 400, 1200, 200 };
+static const size_t windows[] = { 1, 2, 4, 8 };
+static const double loss_rates[] = { 0.0, 0.01, 0.05, 0.1 };
+
+enum event_type {
+	EVENT_DELIVERED,
+	EVENT_PUBACK,
+	EVENT_DISCONNECT
+};
+
+struct event {
+	enum event_type type;
+	int64_t time;
+	/* Connection the event belongs to. */
+	uint32_t epoch;
+	uint16_t message_id;
+	int msg;
+};
+
+/* Message as seen by the Data module and the broker. */
+struct msg {
+	size_t len;
+	int64_t produced;
+	int64_t delivered;
+	int deliveries;
+	bool acked;
+};
+
+struct result {
+	int produced;
+	int delivered;
+	int duplicates;
+	uint32_t retransmissions;
+	double latency;
+	double throughput;
+};
+
+static struct {
+	bool qos_1;
+	double loss_rate;
+	int64_t now;
+	bool connected;
+	uint32_t epoch;
+	int64_t link_free;
+	int64_t reconnect;
+	uint32_t random;
+	struct event events[EVENTS_MAX];
+	size_t event_count;
+	struct msg msgs[MSGS_MAX];
+	int msg_count;
+	/* Messages held by the Data module while the list is full. */
+	int backlog;
+	struct qos_list list;
+	struct qos_list_msg list_msgs[LIST_SIZE];
+	int errors;
+} sim;
+
+int64_t k_uptime_get(void)
+{
+	return sim.now;
+}
+
+static double random_get(void)
+{
+	/* xorshift32, seeded per run to make the results reproducible. */
+	sim.random ^= sim.random << 13;
+	sim.random ^= sim.random >> 17;
+	sim.random ^= sim.random << 5;
+
+	return (double)sim.random / UINT32_MAX;
+}
+
+static void event_add(enum event_type type, int64_t time,
+		      uint16_t message_id, int msg)
+{
+	if (sim.event_count == EVENTS_MAX) {
+		fprintf(stderr, "Event list full\n");
+		exit(1);
+	}
+
+	sim.events[sim.event_count++] = (struct event) {
+		.type = type,
+		.time = time,
+		.epoch = sim.epoch,
+		.message_id = message_id,
+		.msg = msg
+	};
+}
+
+/* Hand a message to the link. Returns false if it is lost. */
+static bool link_send(int msg, uint16_t message_id)
+{
+	int64_t sent;
+
+	sent = MAX(sim.now, sim.link_free) +
+	       (int64_t)(sim.msgs[msg].len / LINK_RATE);
+	sim.link_free = sent;
+
+	if (random_get() < sim.loss_rate) {
+		event_add(EVENT_DISCONNECT, sent, 0, msg);
+		return false;
+	}
+
+	event_add(EVENT_DELIVERED, sent + LINK_RTT_MS / 2, 0, msg);
+
+	if (sim.qos_1) {
+		event_add(EVENT_PUBACK, sent + LINK_RTT_MS, message_id, msg);
+	}
+
+	return true;
+}
+
+static int send_cb(int type, char *buf, size_t len, uint16_t message_id,
+		   bool last)
+{
+	if (!sim.connected) {
+		return -ENOTCONN;
+	}
+
+	link_send((struct msg *)buf - sim.msgs, message_id);
+
+	return 0;
+}
+
+static void ack_cb(void *buf)
+{
+	struct msg *msg = buf;
+
+	if (msg->deliveries == 0) {
+		fprintf(stderr, "Message %td acked before delivery\n",
+			msg - sim.msgs);
+		sim.errors++;
+	}
+
+	msg->acked = true;
+}
+
+/* Move messages held by the Data module to the list. */
+static void backlog_add(void)
+{
+	while (sim.backlog < sim.msg_count) {
+		struct msg *msg = &sim.msgs[sim.backlog];
+
+		if (qos_list_add(&sim.list, 0, (char *)msg, msg->len)) {
+			break;
+		}
+
+		sim.backlog++;
+	}
+
+	if (sim.connected) {
+		qos_list_process(&sim.list);
+	}
+}
+
+static void produce(size_t len)
+{
+	int msg = sim.msg_count++;
+
+	sim.msgs[msg] = (struct msg) {
+		.len = len,
+		.produced = sim.now
+	};
+
+	if (sim.qos_1) {
+		backlog_add();
+		return;
+	}
+
+	/* QoS 0 publications are acknowledged whether or not they could be
+	 * sent.
+	 */
+	if (sim.connected) {
+		link_send(msg, 0);
+	}
+
+	sim.msgs[msg].acked = true;
+	sim.backlog++;
+}
+
+static void event_handle(const struct event *event)
+{
+	struct msg *msg = &sim.msgs[event->msg];
+
+	if (event->epoch != sim.epoch) {
+		return;
+	}
+
+	switch (event->type) {
+	case EVENT_DELIVERED:
+		if (msg->deliveries++ == 0) {
+			msg->delivered = sim.now;
+		}
+		break;
+	case EVENT_PUBACK:
+		qos_list_ack(&sim.list, event->message_id);
+		backlog_add();
+		break;
+	case EVENT_DISCONNECT:
+		sim.connected = false;
+		sim.epoch++;
+		sim.reconnect = sim.now + RECONNECT_DELAY_MS;
+		sim.link_free = sim.now;
+
+		if (sim.qos_1) {
+			qos_list_reset(&sim.list);
+		}
+		break;
+	}
+}
+
+static bool idle(void)
+{
+	return (sim.backlog == sim.msg_count) &&
+	       (!sim.qos_1 || (qos_list_count(&sim.list) == 0)) &&
+	       (sim.event_count == 0);
+}
+
+/* Run events until the given time, or until all messages have been
+ * handled if end is 0.
+ */
+static void run(int64_t end)
+{
+	while ((end != 0) || !idle()) {
+		int64_t next = INT64_MAX;
+		size_t index = 0;
+
+		for (size_t i = 0; i < sim.event_count; i++) {
+			if (sim.events[i].time < next) {
+				next = sim.events[i].time;
+				index = i;
+			}
+		}
+
+		if (!sim.connected && (sim.reconnect <= next)) {
+			next = sim.reconnect;
+			index = EVENTS_MAX;
+		}
+
+		if ((end != 0) && (next > end)) {
+			sim.now = end;
+			return;
+		}
+
+		sim.now = next;
+
+		if (index == EVENTS_MAX) {
+			sim.connected = true;
+			sim.link_free = sim.now;
+
+			if (sim.qos_1) {
+				qos_list_process(&sim.list);
+			}
+
+			continue;
+		}
+
+		struct event event = sim.events[index];
+
+		sim.events[index] = sim.events[--sim.event_count];
+		event_handle(&event);
+	}
+}
+
+static void sim_init(bool qos_1, size_t window, double loss_rate,
+		     uint32_t seed)
+{
+	memset(&sim, 0, sizeof(sim));
+
+	sim.qos_1 = qos_1;
+	sim.loss_rate = loss_rate;
+	sim.connected = true;
+	sim.random = seed;
+
+	qos_list_init(&sim.list, sim.list_msgs, LIST_SIZE, window, send_cb,
+		      ack_cb);
+}
+
+static void result_add(struct result *result)
+{
+	for (int i = 0; i < sim.msg_count; i++) {
+		const struct msg *msg = &sim.msgs[i];
+
+		result->produced++;
+
+		if (msg->deliveries == 0) {
+			continue;
+		}
+
+		result->delivered++;
+		result->duplicates += msg->deliveries - 1;
+		result->latency += (msg->delivered - msg->produced) /
+				   (double)MSEC_PER_SEC;
+	}
+
+	if (!sim.qos_1) {
+		return;
+	}
+
+	result->retransmissions += sim.list.stats.retransmissions;
+
+	if ((sim.list.stats.added !=
+	     sim.list.stats.acked + qos_list_count(&sim.list)) ||
+	    (sim.list.stats.dropped != 0)) {
+		fprintf(stderr, "Statistics do not add up\n");
+		sim.errors++;
+	}
+}
+
+/* A day of periodic traffic followed by a drain period without new
+ * messages.
+ */
+static int periodic_run(bool qos_1, size_t window, double loss_rate,
+			struct result *result)
+{
+	sim_init(qos_1, window, loss_rate, 0x5eed1234);
+
+	for (int cycle = 0; cycle < CYCLES; cycle++) {
+		for (size_t i = 0; i < ARRAY_SIZE(cycle_len); i++) {
+			produce(cycle_len[i]);
+		}
+
+		run((int64_t)(cycle + 1) * CYCLE_MS);
+	}
+
+	run(sim.now + DRAIN_MS);
+	result_add(result);
+
+	if (result->delivered > 0) {
+		result->latency /= result->delivered;
+	}
+
+	if (qos_1 && (result->delivered != result->produced)) {
+		fprintf(stderr, "%d of %d messages not delivered\n",
+			result->produced - result->delivered,
+			result->produced);
+		sim.errors++;
+	}
+
+	return sim.errors;
+}
+
+/* A burst that fills the list, throughput in delivered bytes per second
+ * from the start of the burst to the last delivery.
+ */
+static int burst_run(bool qos_1, size_t window, double loss_rate,
+		     struct result *result)
+{
+	int errors = 0;
+
+	for (int i = 0; i < BURST_RUNS; i++) {
+		int64_t last = 0;
+		size_t bytes = 0;
+
+		sim_init(qos_1, window, loss_rate, 0x5eed0000 + i);
+
+		for (int j = 0; j < LIST_SIZE; j++) {
+			produce(BURST_LEN);
+		}
+
+		run(0);
+
+		for (int j = 0; j < sim.msg_count; j++) {
+			if (sim.msgs[j].deliveries > 0) {
+				bytes += sim.msgs[j].len;
+				last = MAX(last, sim.msgs[j].delivered);
+			}
+		}
+
+		if (last > 0) {
+			result->throughput += bytes * (double)MSEC_PER_SEC /
+					      last;
+		}
+
+		errors += sim.errors;
+	}
+
+	result->throughput /= BURST_RUNS;
+
+	return errors;
+}
+
+static void result_print(const char *name, double loss_rate,
+			 const struct result *periodic,
+			 const struct result *burst)
+{
+	printf("%4.0f%%  %-6s %9.2f%% %6d %6u %9.2f %11.0f\n",
+	       loss_rate * 100, name,
+	       periodic->delivered * 100.0 / periodic->produced,
+	       periodic->duplicates, periodic->retransmissions,
+	       periodic->latency, burst->throughput);
+}
+
+int main(int argc, char *argv[])
+{
+	int errors = 0;
+
+	printf("%d messages in %d cycles, %d bursts of %d x %d bytes\n",
+	       CYCLES * (int)ARRAY_SIZE(cycle_len), CYCLES, BURST_RUNS,
+	       LIST_SIZE, BURST_LEN);
+	printf("Link %.0f kbit/s, RTT %d ms, reconnection %d ms\n\n",
+	       LINK_RATE * 8, LINK_RTT_MS, RECONNECT_DELAY_MS);
+	printf("Loss   Mode   Delivered    Dup  Retx  Latency s  Burst B/s\n");
+
+	for (size_t i = 0; i < ARRAY_SIZE(loss_rates); i++) {
+		struct result periodic = { 0 };
+		struct result burst = { 0 };
+		double no_window = 0;
+
+		errors += periodic_run(false, 0, loss_rates[i], &periodic);
+		errors += burst_run(false, 0, loss_rates[i], &burst);
+		result_print("QoS 0", loss_rates[i], &periodic, &burst);
+
+		for (size_t j = 0; j < ARRAY_SIZE(windows); j++) {
+			char name[16];
+
+			memset(&periodic, 0, sizeof(periodic));
+			memset(&burst, 0, sizeof(burst));
+
+			errors += periodic_run(true, windows[j],
+					       loss_rates[i], &periodic);
+			errors += burst_run(true, windows[j], loss_rates[i],
+					    &burst);
+
+			snprintf(name, sizeof(name), "W %zu", windows[j]);
+			result_print(name, loss_rates[i], &periodic, &burst);
+
+			/* A window must not slow down a burst. */
+			if (j == 0) {
+				no_window = burst.throughput;
+			} else if (burst.throughput < no_window) {
+				fprintf(stderr, "Window %zu slower than 1\n",
+					windows[j]);
+				errors++;
+			}
+		}
+
+		printf("\n");
+	}
+
+	if (errors) {
+		printf("FAILED, %d errors\n", errors);
+		return 1;
+	}
+
+	printf("OK\n");
+
+	return 0;
+}